@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+#include <new>
+#include "bitmatrix.h"
+
+bitrow& bitrow::operator=(const bitrow& other)
+{
+	assert(nbits == other.nbits);
+	if (w != other.w)
+		memcpy(w, other.w, nwords() * sizeof(word));
+	return *this;
+}
+
+bitrow& bitrow::operator=(const bitvector& other)
+{
+	assert(nbits == other.size());
+	memcpy(w, other.data(), nwords() * sizeof(word));
+	return *this;
+}
+
+void bitrow::fill(bool b)
+{
+	size_t n = nwords();
+	memset(w, b ? 0xff : 0, n * sizeof(word));
+	if (b && nbits % bitvector::word_bits)
+		w[n - 1] &= (word(1) << (nbits % bitvector::word_bits)) - 1;
+}
+
+bitrow& bitrow::operator|=(const bitrow& other)
+{
+	assert(nbits == other.nbits);
+	bitops::or_words(w, w, other.w, nwords());
+	return *this;
+}
+
+bitrow& bitrow::operator-=(const bitrow& other)
+{
+	assert(nbits == other.nbits);
+	bitops::andnot_words(w, w, other.w, nwords());
+	return *this;
+}
+
+bitrow& bitrow::operator-=(const bitvector& other)
+{
+	assert(nbits == other.size());
+	bitops::andnot_words(w, w, other.data(), nwords());
+	return *this;
+}
+
+bitrow& bitrow::operator&=(const bitrow& other)
+{
+	assert(nbits == other.nbits);
+	bitops::and_words(w, w, other.w, nwords());
+	return *this;
+}
+
+bool bitrow::assign_transfer(const bitrow& gen, const bitrow& in, const bitrow& kill)
+{
+	assert(nbits == gen.nbits && nbits == in.nbits && nbits == kill.nbits);
+	return bitops::transfer_words(w, gen.w, in.w, kill.w, nwords());
+}
+
+bool operator==(const bitrow& left, const bitrow& right)
+{
+	return left.nbits == right.nbits && bitops::equal_words(left.w, right.w, left.nwords());
+}
+
+ostream& operator<<(ostream& os, const bitrow& d)
+{
+	//bit mask
+	for (unsigned i = 0; i < d.nbits; ++i)
+		os << (int)d[i];
+	return os;
+}
+
+bitmatrix::bitmatrix(unsigned rows, unsigned cols, bool b) : data_(NULL), rows_(rows), cols_(cols)
+{
+	//round rows up to whole cache lines
+	stride_ = (cols + line_words * bitvector::word_bits - 1) / (line_words * bitvector::word_bits) * line_words;
+	size_t bytes = max((size_t)1, rows * stride_) * sizeof(word);
+	void *p;
+	if (posix_memalign(&p, line_words * sizeof(word), bytes))
+		throw bad_alloc();
+	data_ = (word *)p;
+	memset(data_, 0, bytes);
+	if (b)
+		for (unsigned i = 0; i < rows; ++i)
+			(*this)[i].fill(true);
+}
+
+bitmatrix::~bitmatrix()
+{
+	free(data_);
+}
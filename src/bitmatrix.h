@@ -0,0 +1,141 @@
+#ifndef BITMATRIX_H
+#define BITMATRIX_H
+
+#include <iostream>
+#include <vector>
+#include "bitvector.h"
+
+using namespace std;
+
+//one row of a bitmatrix, a view with the bitvector interface,
+//assignment copies the bits and rows of one matrix must be used together
+class bitrow
+{
+
+public:
+    typedef bitvector::word word;
+    typedef bitvector::reference reference;
+    typedef bitvector::const_iterator const_iterator;
+
+private:
+    word *w;
+    unsigned nbits;
+
+    size_t nwords() const { return (nbits + bitvector::word_bits - 1) / bitvector::word_bits; }
+
+public:
+    bitrow(word *a, unsigned b) : w(a), nbits(b) {}
+
+    bitrow(const bitrow& other) : w(other.w), nbits(other.nbits) {}
+
+    bitrow& operator=(const bitrow& other);
+
+    bitrow& operator=(const bitvector& other);
+
+    unsigned size() const { return nbits; }
+
+    word *data() { return w; }
+
+    const word *data() const { return w; }
+
+    size_t words() const { return nwords(); }
+
+    void fill(bool b);
+
+    const_iterator begin() const { return const_iterator(w, w + nwords()); }
+
+    const_iterator end() const { return const_iterator(w + nwords(), w + nwords()); }
+
+    //index of the lowest set bit or -1
+    int find_first() const
+    {
+        const_iterator it = begin();
+        return it == end() ? -1 : *it;
+    }
+
+    reference operator[](int i) { return reference(&w[i / bitvector::word_bits], i % bitvector::word_bits); }
+
+    bool operator[](int i) const { return (w[i / bitvector::word_bits] >> (i % bitvector::word_bits)) & 1; }
+
+    bitrow& operator|=(const bitrow& other);
+
+    bitrow& operator-=(const bitrow& other);
+
+    bitrow& operator-=(const bitvector& other);
+
+    bitrow& operator&=(const bitrow& other);
+
+    //*this = gen | (in & ~kill), returns true if *this has changed
+    bool assign_transfer(const bitrow& gen, const bitrow& in, const bitrow& kill);
+
+    friend bool operator==(const bitrow& left, const bitrow& right);
+
+    friend ostream& operator<<(ostream& os, const bitrow& d);
+};
+
+//rows x cols bits in one allocation, every row starts on its own cache line
+//so sweeps over all rows stream through memory
+class bitmatrix
+{
+
+public:
+    typedef bitvector::word word;
+
+    static const unsigned line_words = 64 / sizeof(word);
+
+private:
+    word *data_;
+    unsigned rows_, cols_;
+    size_t stride_;
+
+    bitmatrix(const bitmatrix&);
+
+    bitmatrix& operator=(const bitmatrix&);
+
+public:
+    bitmatrix(unsigned rows, unsigned cols, bool b = false);
+
+    ~bitmatrix();
+
+    unsigned rows() const { return rows_; }
+
+    unsigned cols() const { return cols_; }
+
+    bitrow operator[](unsigned i) { return bitrow(data_ + i * stride_, cols_); }
+
+    const bitrow operator[](unsigned i) const { return bitrow(data_ + i * stride_, cols_); }
+};
+
+//per-block sets of equal size, indexed by block,
+//dense sets share one bitmatrix and other set types are kept in a vector
+template<typename Set>
+class set_table
+{
+
+private:
+    vector<Set> rows;
+
+public:
+    set_table(int n, int size, bool b = false) : rows(n, Set(size, b)) {}
+
+    Set& operator[](int i) { return rows[i]; }
+
+    const Set& operator[](int i) const { return rows[i]; }
+};
+
+template<>
+class set_table<bitvector>
+{
+
+private:
+    bitmatrix m;
+
+public:
+    set_table(int n, int size, bool b = false) : m(n, size, b) {}
+
+    bitrow operator[](int i) { return m[i]; }
+
+    const bitrow operator[](int i) const { return m[i]; }
+};
+
+#endif
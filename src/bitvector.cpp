@@ -1,66 +1,355 @@
+#include <algorithm>
 #include "bitvector.h"
+#include "bitmatrix.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITVECTOR_X86
+#endif
+
+namespace {
+
+typedef bitvector::word word;
+
+//word operations, each one in scalar, sse2 and avx2 flavours
+struct op_or
+{
+	static word w(word a, word b) { return a | b; }
+#ifdef BITVECTOR_X86
+	__attribute__((target("sse2"))) static __m128i sse(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+	__attribute__((target("avx2"))) static __m256i avx(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#endif
+};
+
+struct op_andnot
+{
+	static word w(word a, word b) { return a & ~b; }
+#ifdef BITVECTOR_X86
+	__attribute__((target("sse2"))) static __m128i sse(__m128i a, __m128i b) { return _mm_andnot_si128(b, a); }
+	__attribute__((target("avx2"))) static __m256i avx(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+#endif
+};
+
+struct op_and
+{
+	static word w(word a, word b) { return a & b; }
+#ifdef BITVECTOR_X86
+	__attribute__((target("sse2"))) static __m128i sse(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+	__attribute__((target("avx2"))) static __m256i avx(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#endif
+};
+
+template<typename F>
+void binop_generic(word *d, const word *a, const word *b, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		d[i] = F::w(a[i], b[i]);
+}
+
+bool equal_generic(const word *a, const word *b, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		if (a[i] != b[i])
+			return false;
+	return true;
+}
+
+//out = gen | (in & ~kill), returns true if out has changed
+bool transfer_generic(word *out, const word *gen, const word *in, const word *kill, size_t n)
+{
+	word diff = 0;
+	for (size_t i = 0; i < n; ++i) {
+		word x = gen[i] | (in[i] & ~kill[i]);
+		diff |= x ^ out[i];
+		out[i] = x;
+	}
+	return diff != 0;
+}
+
+#ifdef BITVECTOR_X86
+template<typename F>
+__attribute__((target("sse2"))) void binop_sse2(word *d, const word *a, const word *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+		_mm_storeu_si128((__m128i *)(d + i), F::sse(x, y));
+	}
+	for (; i < n; ++i)
+		d[i] = F::w(a[i], b[i]);
+}
+
+__attribute__((target("sse2"))) bool equal_sse2(const word *a, const word *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff)
+			return false;
+	}
+	for (; i < n; ++i)
+		if (a[i] != b[i])
+			return false;
+	return true;
+}
+
+__attribute__((target("sse2"))) bool transfer_sse2(word *out, const word *gen, const word *in, const word *kill, size_t n)
+{
+	size_t i = 0;
+	__m128i diff = _mm_setzero_si128();
+	for (; i + 2 <= n; i += 2) {
+		__m128i x = _mm_or_si128(_mm_loadu_si128((const __m128i *)(gen + i)),
+			_mm_andnot_si128(_mm_loadu_si128((const __m128i *)(kill + i)), _mm_loadu_si128((const __m128i *)(in + i))));
+		diff = _mm_or_si128(diff, _mm_xor_si128(x, _mm_loadu_si128((const __m128i *)(out + i))));
+		_mm_storeu_si128((__m128i *)(out + i), x);
+	}
+	bool changed = _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xffff;
+	return transfer_generic(out + i, gen + i, in + i, kill + i, n - i) || changed;
+}
+
+template<typename F>
+__attribute__((target("avx2"))) void binop_avx2(word *d, const word *a, const word *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+		__m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+		_mm256_storeu_si256((__m256i *)(d + i), F::avx(x, y));
+	}
+	for (; i < n; ++i)
+		d[i] = F::w(a[i], b[i]);
+}
+
+__attribute__((target("avx2"))) bool equal_avx2(const word *a, const word *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+		__m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+		__m256i z = _mm256_xor_si256(x, y);
+		if (!_mm256_testz_si256(z, z))
+			return false;
+	}
+	for (; i < n; ++i)
+		if (a[i] != b[i])
+			return false;
+	return true;
+}
+
+__attribute__((target("avx2"))) bool transfer_avx2(word *out, const word *gen, const word *in, const word *kill, size_t n)
+{
+	size_t i = 0;
+	__m256i diff = _mm256_setzero_si256();
+	for (; i + 4 <= n; i += 4) {
+		__m256i x = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(gen + i)),
+			_mm256_andnot_si256(_mm256_loadu_si256((const __m256i *)(kill + i)), _mm256_loadu_si256((const __m256i *)(in + i))));
+		diff = _mm256_or_si256(diff, _mm256_xor_si256(x, _mm256_loadu_si256((const __m256i *)(out + i))));
+		_mm256_storeu_si256((__m256i *)(out + i), x);
+	}
+	bool changed = !_mm256_testz_si256(diff, diff);
+	return transfer_generic(out + i, gen + i, in + i, kill + i, n - i) || changed;
+}
+#endif
+
+typedef void (*binop_kernel)(word *, const word *, const word *, size_t);
+
+struct kernels
+{
+	binop_kernel or_, andnot_, and_;
+	bool (*equal)(const word *, const word *, size_t);
+	bool (*transfer)(word *, const word *, const word *, const word *, size_t);
+};
+
+//pick the widest instruction set the cpu supports
+kernels select_kernels()
+{
+#ifdef BITVECTOR_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return {binop_avx2<op_or>, binop_avx2<op_andnot>, binop_avx2<op_and>, equal_avx2, transfer_avx2};
+	if (__builtin_cpu_supports("sse2"))
+		return {binop_sse2<op_or>, binop_sse2<op_andnot>, binop_sse2<op_and>, equal_sse2, transfer_sse2};
+#endif
+	return {binop_generic<op_or>, binop_generic<op_andnot>, binop_generic<op_and>, equal_generic, transfer_generic};
+}
+
+const kernels& impl()
+{
+	static const kernels k = select_kernels();
+	return k;
+}
+
+size_t words_for(unsigned bits)
+{
+	return (bits + bitvector::word_bits - 1) / bitvector::word_bits;
+}
+
+}
+
+bitvector::bitvector(unsigned a, bool b) : words(words_for(a), b ? ~word(0) : word(0)), nbits(a)
+{
+	clear_tail();
+}
+
+bitvector::bitvector(const bitrow& a) : words(a.data(), a.data() + words_for(a.size())), nbits(a.size())
+{
+}
+
+bitvector::bitvector(const vector<bool>& a) : words(words_for(a.size()), 0), nbits(a.size())
+{
+	for (unsigned i = 0; i < nbits; ++i)
+		if (a[i])
+			words[i / word_bits] |= word(1) << (i % word_bits);
+}
+
+//bits past nbits in the last word are always kept zero
+void bitvector::clear_tail()
+{
+	if (nbits % word_bits)
+		words.back() &= (word(1) << (nbits % word_bits)) - 1;
+}
 
 bitvector& bitvector::operator=(const bitvector& other)
 {
-	if (this != &other)
-		bits = other.bits;
+	if (this != &other) {
+		words = other.words;
+		nbits = other.nbits;
+	}
 	return *this;
 }
 
-const bitvector bitvector::op(const bitvector& left, const bitvector& right, function<bool(bool, bool)> fn)
+const bitvector bitvector::op(const bitvector& left, const bitvector& right, kernel fn)
+{
+	bitvector tmp(min(left.nbits, right.nbits));
+	if (!tmp.words.empty())
+		fn(tmp.words.data(), left.words.data(), right.words.data(), tmp.words.size());
+	tmp.clear_tail();
+	return tmp;
+}
+
+//in place version keeps the semantics of a = a op b, the result is min(size) bits long
+bitvector& bitvector::op_assign(const word *other, unsigned other_bits, kernel fn)
 {
-	vector<bool> tmp;
-	vector<bool>::const_iterator a = left.bits.begin(), b = right.bits.begin();
-	while (a != left.bits.end() && b != right.bits.end()) {
-		tmp.push_back(fn(*a, *b));
-		++a;
-		++b;
+	if (other_bits < nbits) {
+		nbits = other_bits;
+		words.resize(words_for(nbits));
 	}
-	return bitvector(tmp);
+	if (!words.empty())
+		fn(words.data(), words.data(), other, words.size());
+	clear_tail();
+	return *this;
+}
+
+void bitvector::fill(bool b)
+{
+	std::fill(words.begin(), words.end(), b ? ~word(0) : word(0));
+	clear_tail();
+}
+
+bitvector& bitvector::operator|=(const bitvector& other)
+{
+	return op_assign(other.data(), other.nbits, impl().or_);
+}
+
+bitvector& bitvector::operator-=(const bitvector& other)
+{
+	return op_assign(other.data(), other.nbits, impl().andnot_);
+}
+
+bitvector& bitvector::operator&=(const bitvector& other)
+{
+	return op_assign(other.data(), other.nbits, impl().and_);
+}
+
+bitvector& bitvector::operator|=(const bitrow& other)
+{
+	return op_assign(other.data(), other.size(), impl().or_);
+}
+
+bitvector& bitvector::operator-=(const bitrow& other)
+{
+	return op_assign(other.data(), other.size(), impl().andnot_);
 }
 
-vector<bool>::reference bitvector::operator[](int i) {
-	return bits[i];
+bitvector& bitvector::operator&=(const bitrow& other)
+{
+	return op_assign(other.data(), other.size(), impl().and_);
 }
 
-vector<bool>::const_reference bitvector::operator[](int i) const {
-	return bits[i];
+bool bitvector::assign_transfer(const bitvector& gen, const bitvector& in, const bitvector& kill)
+{
+	if (gen.nbits != nbits || in.nbits != nbits || kill.nbits != nbits) {
+		bitvector tmp = gen + (in - kill);
+		bool changed = !(tmp == *this);
+		*this = tmp;
+		return changed;
+	}
+	if (words.empty())
+		return false;
+	return impl().transfer(words.data(), gen.words.data(), in.words.data(), kill.words.data(), words.size());
 }
 
 const bitvector operator+(const bitvector& left, const bitvector& right)
 {
-	return bitvector::op(left, right, [](bool a, bool b){return a | b;});
+	return bitvector::op(left, right, impl().or_);
 }
 
 const bitvector operator-(const bitvector& left, const bitvector& right)
 {
-	return bitvector::op(left, right, [](bool a, bool b){return a & ~b;});
+	return bitvector::op(left, right, impl().andnot_);
 }
 
 const bitvector operator*(const bitvector& left, const bitvector& right)
 {
-	return bitvector::op(left, right, [](bool a, bool b){return a & b;});
+	return bitvector::op(left, right, impl().and_);
 }
 
 bool operator==(const bitvector& left, const bitvector& right)
 {
-	return left.bits == right.bits;
+	return left.nbits == right.nbits && impl().equal(left.words.data(), right.words.data(), left.words.size());
+}
+
+bool operator==(const bitvector& left, const bitrow& right)
+{
+	return left.nbits == right.size() && impl().equal(left.words.data(), right.data(), left.words.size());
+}
+
+bool operator==(const bitrow& left, const bitvector& right)
+{
+	return right == left;
 }
 
 ostream& operator<<(ostream& os, const bitvector& d)
 {
 	//bit mask
-	for (auto it = d.bits.begin(), e = d.bits.end(); it != e; ++it)
-		os << (int)*it;
+	for (unsigned i = 0; i < d.nbits; ++i)
+		os << (int)d[i];
 	return os;
 }
 
-bitvector::operator vector<int>()
+void bitops::or_words(word *d, const word *a, const word *b, size_t n)
+{
+	impl().or_(d, a, b, n);
+}
+
+void bitops::andnot_words(word *d, const word *a, const word *b, size_t n)
+{
+	impl().andnot_(d, a, b, n);
+}
+
+void bitops::and_words(word *d, const word *a, const word *b, size_t n)
+{
+	impl().and_(d, a, b, n);
+}
+
+bool bitops::equal_words(const word *a, const word *b, size_t n)
+{
+	return impl().equal(a, b, n);
+}
+
+bool bitops::transfer_words(word *out, const word *gen, const word *in, const word *kill, size_t n)
 {
-    vector<int> tmp;
-    int k = bits.size();
-    for (int i = 0; i < k; ++i)
-        if (bits[i])
-            tmp.push_back(i);
-    return tmp;
+	return impl().transfer(out, gen, in, kill, n);
 }
@@ -3,29 +3,137 @@
 
 #include <iostream>
 #include <vector>
-#include <functional>
 #include <iterator>
+#include <stdint.h>
 
 using namespace std;
 
+class bitrow;
+
 class bitvector
 {
 
+public:
+    typedef uint64_t word;
+
+    static const unsigned word_bits = 64;
+
+    //proxy for a single bit, plays the role of vector<bool>::reference
+    class reference
+    {
+
+    private:
+        word *w_;
+        word mask_;
+
+    public:
+        reference(word *w, unsigned bit) : w_(w), mask_(word(1) << bit) {}
+
+        operator bool() const { return (*w_ & mask_) != 0; }
+
+        reference& operator=(bool b)
+        {
+            if (b)
+                *w_ |= mask_;
+            else
+                *w_ &= ~mask_;
+            return *this;
+        }
+
+        reference& operator=(const reference& other) { return *this = bool(other); }
+    };
+
+    //walks the indexes of set bits in increasing order
+    class const_iterator
+    {
+
+    private:
+        const word *w_, *end_;
+        word cur_;
+        int base_;
+
+        void skip_empty()
+        {
+            while (cur_ == 0 && w_ != end_)
+                if (++w_ != end_) {
+                    cur_ = *w_;
+                    base_ += word_bits;
+                }
+        }
+
+    public:
+        const_iterator(const word *w, const word *end) : w_(w), end_(end), cur_(w < end ? *w : 0), base_(0) { skip_empty(); }
+
+        int operator*() const { return base_ + __builtin_ctzll(cur_); }
+
+        const_iterator& operator++()
+        {
+            cur_ &= cur_ - 1;
+            skip_empty();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return w_ == other.w_ && cur_ == other.cur_; }
+
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+
 private:
-    vector<bool> bits;
+    vector<word> words;
+    unsigned nbits;
+
+    void clear_tail();
+
+    typedef void (*kernel)(word *, const word *, const word *, size_t);
+
+    static const bitvector op(const bitvector& left, const bitvector& right, kernel fn);
+
+    bitvector& op_assign(const word *other, unsigned other_bits, kernel fn);
 
 public:
-    bitvector(unsigned a = 0, bool b = false) { bits.assign(a, b); }
+    bitvector(unsigned a = 0, bool b = false);
+
+    bitvector(const vector<bool>& a);
 
-    bitvector(const vector<bool>& a) { bits = a; }
+    explicit bitvector(const bitrow& a);
 
     bitvector& operator=(const bitvector& other);
 
-    static const bitvector op(const bitvector& left, const bitvector& right, function<bool(bool, bool)> fn);
+    unsigned size() const { return nbits; }
 
-    vector<bool>::reference operator[](int i);
+    const word *data() const { return words.data(); }
 
-    vector<bool>::const_reference operator[](int i) const;
+    void fill(bool b);
+
+    const_iterator begin() const { return const_iterator(words.data(), words.data() + words.size()); }
+
+    const_iterator end() const { return const_iterator(words.data() + words.size(), words.data() + words.size()); }
+
+    //index of the lowest set bit or -1
+    int find_first() const
+    {
+        const_iterator it = begin();
+        return it == end() ? -1 : *it;
+    }
+
+    reference operator[](int i) { return reference(&words[i / word_bits], i % word_bits); }
+
+    bool operator[](int i) const { return (words[i / word_bits] >> (i % word_bits)) & 1; }
+
+    bitvector& operator|=(const bitvector& other);
+
+    bitvector& operator-=(const bitvector& other);
+
+    bitvector& operator&=(const bitvector& other);
+
+    bitvector& operator|=(const bitrow& other);
+
+    bitvector& operator-=(const bitrow& other);
+
+    bitvector& operator&=(const bitrow& other);
+
+    //*this = gen | (in & ~kill), returns true if *this has changed
+    bool assign_transfer(const bitvector& gen, const bitvector& in, const bitvector& kill);
 
     friend const bitvector operator+(const bitvector& left, const bitvector& right);
 
@@ -35,9 +143,29 @@ public:
 
     friend bool operator==(const bitvector& left, const bitvector& right);
 
-    friend ostream& operator<<(ostream& os, const bitvector& d);
+    friend bool operator==(const bitvector& left, const bitrow& right);
+
+    friend bool operator==(const bitrow& left, const bitvector& right);
 
-    operator vector<int>();
+    friend ostream& operator<<(ostream& os, const bitvector& d);
 };
 
+//word kernels behind the set operations, shared with bitrow,
+//the sse2, avx2 or portable version is chosen at runtime
+namespace bitops
+{
+
+void or_words(bitvector::word *d, const bitvector::word *a, const bitvector::word *b, size_t n);
+
+void andnot_words(bitvector::word *d, const bitvector::word *a, const bitvector::word *b, size_t n);
+
+void and_words(bitvector::word *d, const bitvector::word *a, const bitvector::word *b, size_t n);
+
+bool equal_words(const bitvector::word *a, const bitvector::word *b, size_t n);
+
+//out = gen | (in & ~kill), returns true if out has changed
+bool transfer_words(bitvector::word *out, const bitvector::word *gen, const bitvector::word *in, const bitvector::word *kill, size_t n);
+
+}
+
 #endif
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+static const char cache_magic[8] = {'c', 'c', 'c', 'c', 'a', 'c', 'h', 'e'};
+//bumped whenever the layout of any section changes
+static const uint32_t cache_version = 1;
+
+uint64_t hash_bytes(const char *p, size_t n)
+{
+	const uint64_t k = 0x9e3779b97f4a7c15ULL;
+	uint64_t h = n * k, w;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		memcpy(&w, p + i, 8);
+		h = (h ^ w) * k;
+		h ^= h >> 32;
+	}
+	w = 0;
+	memcpy(&w, p + i, n - i);
+	h = (h ^ w) * k;
+	h ^= h >> 29;
+	h *= k;
+	h ^= h >> 32;
+	return h;
+}
+
+cache_writer::cache_writer() : data_(sizeof(cache_header), 0) {}
+
+void cache_writer::align()
+{
+	data_.resize((data_.size() + 7) / 8 * 8, 0);
+}
+
+void cache_writer::begin(int id)
+{
+	align();
+	if (!sections_.empty())
+		sections_.back().size = data_.size() - sections_.back().offset;
+	sections_.push_back({(uint64_t)id, data_.size(), 0});
+}
+
+void cache_writer::put_bytes(const void *p, size_t n)
+{
+	const char *c = (const char *)p;
+	data_.insert(data_.end(), c, c + n);
+}
+
+bool cache_writer::write(const string& path, uint64_t input_size, uint64_t input_hash, uint32_t options)
+{
+	align();
+	if (!sections_.empty())
+		sections_.back().size = data_.size() - sections_.back().offset;
+	for (auto &s : sections_)
+		s.checksum = hash_bytes(&data_[s.offset], s.size);
+	cache_header h;
+	memcpy(h.magic, cache_magic, sizeof(h.magic));
+	h.version = cache_version;
+	h.options = options;
+	h.input_size = input_size;
+	h.input_hash = input_hash;
+	h.table = data_.size();
+	h.sections = sections_.size();
+	put_bytes(sections_.data(), sections_.size() * sizeof(cache_section_entry));
+	h.size = data_.size();
+	h.checksum = hash_bytes((const char *)sections_.data(), sections_.size() * sizeof(cache_section_entry));
+	memcpy(&data_[0], &h, sizeof(h));
+
+	//-server workers may write the same entry at once
+	static atomic<unsigned> writes(0);
+	string tmp = path + ".tmp" + to_string(getpid()) + "-" + to_string(writes++);
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0)
+		return false;
+	const char *p = data_.data();
+	size_t n = data_.size();
+	while (n > 0) {
+		ssize_t r = ::write(fd, p, n);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0)
+			break;
+		p += r;
+		n -= r;
+	}
+	if (::close(fd) != 0 || n > 0 || rename(tmp.c_str(), path.c_str()) != 0) {
+		unlink(tmp.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool cache_reader::open(const string& path, uint64_t input_size, uint64_t input_hash, uint32_t options)
+{
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t)st.st_size < sizeof(cache_header)) {
+		::close(fd);
+		return false;
+	}
+	void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED)
+		return false;
+	map_ = p;
+	size_ = st.st_size;
+	const char *base = (const char *)p;
+	cache_header h;
+	memcpy(&h, base, sizeof(h));
+	bool ok = memcmp(h.magic, cache_magic, sizeof(h.magic)) == 0 && h.version == cache_version
+		&& h.options == options && h.input_size == input_size && h.input_hash == input_hash
+		&& h.size == size_ && h.table >= sizeof(h) && h.table <= size_
+		&& h.sections == (size_ - h.table) / sizeof(cache_section_entry)
+		&& h.checksum == hash_bytes(base + h.table, size_ - h.table);
+	if (ok) {
+		sections_.resize(h.sections);
+		memcpy(sections_.data(), base + h.table, h.sections * sizeof(cache_section_entry));
+		for (auto &s : sections_)
+			if (s.offset < sizeof(h) || s.offset > h.table || s.size > h.table - s.offset)
+				ok = false;
+		checked_.assign(h.sections, 0);
+	}
+	if (!ok)
+		close();
+	return ok;
+}
+
+void cache_reader::close()
+{
+	if (map_)
+		munmap(map_, size_);
+	map_ = NULL;
+	size_ = 0;
+	sections_.clear();
+	checked_.clear();
+	cur_ = end_ = NULL;
+}
+
+bool cache_reader::section(int id)
+{
+	cur_ = end_ = NULL;
+	for (size_t k = 0; k < sections_.size(); ++k) {
+		const cache_section_entry &s = sections_[k];
+		if (s.id != (uint64_t)id)
+			continue;
+		const char *p = (const char *)map_ + s.offset;
+		if (checked_[k] == 0)
+			checked_[k] = hash_bytes(p, s.size) == s.checksum ? 1 : 2;
+		if (checked_[k] == 2)
+			return false;
+		cur_ = p;
+		end_ = p + s.size;
+		return true;
+	}
+	return false;
+}
+
+void cache_reader::get_bytes(void *p, size_t n)
+{
+	size_t k = min(n, (size_t)(end_ - cur_));
+	if (k > 0)
+		memcpy(p, cur_, k);
+	if (k < n)
+		memset((char *)p + k, 0, n - k);
+	cur_ += k;
+}
+
+void cache_reader::align()
+{
+	size_t off = cur_ - (const char *)map_;
+	cur_ = min(end_, cur_ + (8 - off % 8) % 8);
+}
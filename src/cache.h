@@ -0,0 +1,130 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+
+using namespace std;
+
+//64 bit hash of n bytes, for cache keys and checksums, not for adversaries
+uint64_t hash_bytes(const char *p, size_t n);
+
+//A cache entry is one file: a header naming the input it was made from (size,
+//hash and the options that change the results), then sections of arrays of
+//plain values, each one 8 byte aligned so it can be read in place from the
+//mapping, and a table of the sections. The header has a checksum of the table
+//and the table one of every section, so only the sections a run reads are
+//checked, and a damaged one is never used.
+struct cache_header
+{
+    char magic[8];
+    uint32_t version, options;
+    uint64_t input_size, input_hash;
+    uint64_t size;      //of the whole file
+    uint64_t checksum;  //of the section table
+    uint64_t table;     //offset of the section table
+    uint64_t sections;  //entries in the table
+};
+
+struct cache_section_entry
+{
+    uint64_t id, offset, size, checksum;
+};
+
+//builds an entry in memory section by section
+class cache_writer
+{
+
+private:
+    vector<char> data_;
+    vector<cache_section_entry> sections_;
+
+    void align();
+
+public:
+    cache_writer();
+
+    //following puts go to section id
+    void begin(int id);
+
+    void put_bytes(const void *p, size_t n);
+
+    //a plain value
+    template<typename T>
+    void put(const T& x) { put_bytes(&x, sizeof(T)); }
+
+    //the size, then the items of v
+    template<typename T>
+    void put(const vector<T>& v)
+    {
+        put((uint64_t)v.size());
+        align();
+        put_bytes(v.data(), v.size() * sizeof(T));
+        align();
+    }
+
+    //writes a temporary file next to path and renames it over path, so readers
+    //see the old entry or the whole new one, false if it cannot be written
+    bool write(const string& path, uint64_t input_size, uint64_t input_hash, uint32_t options);
+};
+
+//maps an entry and reads its sections, reads past the end of a section give zeros
+class cache_reader
+{
+
+private:
+    void *map_;
+    size_t size_;
+    vector<cache_section_entry> sections_;
+    //0 not checked yet, 1 good, 2 damaged
+    vector<char> checked_;
+    const char *cur_, *end_;
+
+    //skip to the next 8 byte boundary of the file
+    void align();
+
+    cache_reader(const cache_reader&);
+
+    cache_reader& operator=(const cache_reader&);
+
+public:
+    cache_reader() : map_(NULL), size_(0), cur_(NULL), end_(NULL) {}
+
+    ~cache_reader() { close(); }
+
+    //false if there is no entry at path, or it was made from another input,
+    //with other options or an older format, or its section table is damaged
+    bool open(const string& path, uint64_t input_size, uint64_t input_hash, uint32_t options);
+
+    void close();
+
+    //following gets read section id, false if the entry has none or it is damaged
+    bool section(int id);
+
+    void get_bytes(void *p, size_t n);
+
+    template<typename T>
+    T get()
+    {
+        T x;
+        get_bytes(&x, sizeof(T));
+        return x;
+    }
+
+    template<typename T>
+    void get(vector<T>& v)
+    {
+        uint64_t n = get<uint64_t>();
+        align();
+        //a size larger than the rest of the section reads as empty
+        if (n > (uint64_t)(end_ - cur_) / sizeof(T))
+            n = 0;
+        v.resize(n);
+        get_bytes(v.data(), n * sizeof(T));
+        align();
+    }
+};
+
+#endif
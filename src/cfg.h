@@ -0,0 +1,104 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include <vector>
+#include "traverse.h"
+
+using namespace std;
+
+//control flow graph frozen into compressed sparse row arrays once it is built.
+//Edge e runs from source(e) to target(e), the edges leaving b have the ids
+//[first_edge(b), first_edge(b + 1)) in succ order, pred_edges(b) are the ids of
+//the edges entering b in pred order
+class cfg
+{
+
+private:
+    vector<int> succ_begin_, succ_, source_;
+    vector<int> pred_begin_, pred_, pred_edge_;
+
+public:
+    //n blocks and the edges (source, target), succ and pred lists keep the order
+    //the edges are given in
+    void build(int n, const vector<pair<int, int> >& edges)
+    {
+        int m = edges.size();
+        succ_begin_.assign(n + 1, 0);
+        pred_begin_.assign(n + 1, 0);
+        for (auto &e : edges) {
+            ++succ_begin_[e.first + 1];
+            ++pred_begin_[e.second + 1];
+        }
+        for (int b = 0; b < n; ++b) {
+            succ_begin_[b + 1] += succ_begin_[b];
+            pred_begin_[b + 1] += pred_begin_[b];
+        }
+        succ_.resize(m);
+        source_.resize(m);
+        vector<int> fill(succ_begin_.begin(), succ_begin_.end() - 1);
+        vector<int> id(m);
+        for (int k = 0; k < m; ++k) {
+            id[k] = fill[edges[k].first]++;
+            succ_[id[k]] = edges[k].second;
+            source_[id[k]] = edges[k].first;
+        }
+        pred_.resize(m);
+        pred_edge_.resize(m);
+        fill.assign(pred_begin_.begin(), pred_begin_.end() - 1);
+        for (int k = 0; k < m; ++k) {
+            int j = fill[edges[k].second]++;
+            pred_[j] = edges[k].first;
+            pred_edge_[j] = id[k];
+        }
+    }
+
+    int size() const { return (int)succ_begin_.size() - 1; }
+
+    int edges() const { return succ_.size(); }
+
+    block_range succ(int b) const { return block_range(succ_.data() + succ_begin_[b], succ_.data() + succ_begin_[b + 1]); }
+
+    block_range pred(int b) const { return block_range(pred_.data() + pred_begin_[b], pred_.data() + pred_begin_[b + 1]); }
+
+    int first_edge(int b) const { return succ_begin_[b]; }
+
+    block_range pred_edges(int b) const { return block_range(pred_edge_.data() + pred_begin_[b], pred_edge_.data() + pred_begin_[b + 1]); }
+
+    int source(int e) const { return source_[e]; }
+
+    //the edges in an order build turns back into this graph: succ order for
+    //every source and pred order for every target, found by a topological sort
+    vector<pair<int, int> > edge_list() const
+    {
+        int m = edges();
+        //next edge in pred order of the same target, -1 for the last one
+        vector<int> next_in(m, -1), waiting(m, 0), ready;
+        for (int b = 0; b < size(); ++b) {
+            block_range in = pred_edges(b);
+            for (size_t k = 0; k + 1 < in.size(); ++k) {
+                next_in[in[k]] = in[k + 1];
+                ++waiting[in[k + 1]];
+            }
+        }
+        for (int e = 0; e < m; ++e)
+            if (e != succ_begin_[source_[e]])
+                ++waiting[e];
+            else if (waiting[e] == 0)
+                ready.push_back(e);
+        vector<pair<int, int> > out;
+        while (!ready.empty()) {
+            int e = ready.back();
+            ready.pop_back();
+            out.push_back(make_pair(source_[e], succ_[e]));
+            if (e + 1 < succ_begin_[source_[e] + 1] && --waiting[e + 1] == 0)
+                ready.push_back(e + 1);
+            if (next_in[e] != -1 && --waiting[next_in[e]] == 0)
+                ready.push_back(next_in[e]);
+        }
+        return out;
+    }
+
+    int target(int e) const { return succ_[e]; }
+};
+
+#endif
@@ -0,0 +1,366 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "threadpool.h"
+#include "cfg.h"
+#include "traverse.h"
+
+using namespace std;
+
+enum flow_direction
+{
+    FORWARD,
+    BACKWARD
+};
+
+struct solver_stats
+{
+    int iterations; //passes over the blocks, the longest component for the parallel solver
+    long visits;    //transfer function evaluations
+};
+
+//blocks in reverse postorder of a depth first walk from entry,
+//blocks not reachable from entry follow in index order
+inline vector<int> reverse_postorder(const cfg& g, int entry)
+{
+    int n = g.size();
+    vector<int> order;
+    vector<bool> seen(n, false);
+    depth_first(entry, seen, [&](int b){ return g.succ(b); },
+        no_visit(), [&](int b){ order.push_back(b); });
+    reverse(order.begin(), order.end());
+    for (int i = 0; i < n; ++i)
+        if (!seen[i])
+            order.push_back(i);
+    return order;
+}
+
+//A Problem provides
+//  void init(int b)           set the meet input of b to the identity of the meet operator
+//  void meet(int b, int s)    combine the result of s into the meet input of b
+//  bool transfer(int b)       apply the transfer function of b, true if its result has changed
+//and for the incremental solver
+//  bool grow_only()           no result can shrink with the new transfer functions
+//  void reset(int b)          put the result of b aside and lower it to at most the new
+//                             fixpoint, the bottom will always do
+//  bool changed(int b)        the result of b differs from the one put aside by reset
+//Forward problems meet over pred and push to succ, backward ones the other way round.
+//The boundary block (entry or exit) is never evaluated.
+
+//worklist passes over the blocks at the positions start of order, blocks queued
+//behind the current one wait for the next pass, so a pass never restarts from a
+//loop header before the blocks after it have been seen.
+//Only targets accepted by scope(t) are queued
+template<typename Problem, typename Scope>
+void worklist_run(const cfg& g, const vector<int>& order, const vector<int>& pos, flow_direction dir, int boundary,
+                  Problem& pb, const vector<int>& start, Scope scope, vector<char>& queued, solver_stats& stats)
+{
+    //positions of queued blocks for this pass and the next one
+    priority_queue<int, vector<int>, greater<int> > cur(start.begin(), start.end()), next;
+    for (auto i : start)
+        queued[order[i]] = true;
+    while (!cur.empty()) {
+        ++stats.iterations;
+        while (!cur.empty()) {
+            int i = cur.top();
+            cur.pop();
+            int b = order[i];
+            queued[b] = false;
+            ++stats.visits;
+            block_range sources = dir == FORWARD ? g.pred(b) : g.succ(b);
+            block_range targets = dir == FORWARD ? g.succ(b) : g.pred(b);
+            pb.init(b);
+            for (auto s : sources)
+                pb.meet(b, s);
+            if (!pb.transfer(b))
+                continue;
+            for (auto t : targets)
+                if (t != boundary && !queued[t] && scope(t)) {
+                    (pos[t] > i ? cur : next).push(pos[t]);
+                    queued[t] = true;
+                }
+        }
+        swap(cur, next);
+    }
+}
+
+//priority worklist solver: blocks are taken in reverse postorder (postorder for
+//backward problems) and only revisited when one of their inputs has changed
+template<typename Problem>
+solver_stats solve_worklist(const cfg& g, int entry, flow_direction dir, int boundary, Problem& pb)
+{
+    solver_stats stats = {0, 0};
+    int n = g.size();
+    vector<int> order = reverse_postorder(g, entry);
+    if (dir == BACKWARD)
+        reverse(order.begin(), order.end());
+    vector<int> pos(n), start;
+    for (int i = 0; i < n; ++i) {
+        pos[order[i]] = i;
+        if (order[i] != boundary)
+            start.push_back(i);
+    }
+    vector<char> queued(n, false);
+    worklist_run(g, order, pos, dir, boundary, pb, start, [](int){return true;}, queued, stats);
+    return stats;
+}
+
+//strongly connected components of the succ graph (Tarjan), comp[b] is the
+//component of b, returns the number of components
+inline int strong_components(const cfg& g, vector<int>& comp)
+{
+    int n = g.size(), num = 0, nc = 0;
+    vector<int> index(n, -1), low(n), stack;
+    vector<bool> on_stack(n, false);
+    vector<pair<int, size_t> > calls;
+    comp.assign(n, -1);
+    for (int r = 0; r < n; ++r) {
+        if (index[r] != -1)
+            continue;
+        calls.push_back(make_pair(r, 0));
+        index[r] = low[r] = num++;
+        stack.push_back(r);
+        on_stack[r] = true;
+        while (!calls.empty()) {
+            int b = calls.back().first;
+            size_t &k = calls.back().second;
+            block_range succ = g.succ(b);
+            if (k < succ.size()) {
+                int s = succ[k++];
+                if (index[s] == -1) {
+                    index[s] = low[s] = num++;
+                    stack.push_back(s);
+                    on_stack[s] = true;
+                    calls.push_back(make_pair(s, 0));
+                } else if (on_stack[s])
+                    low[b] = min(low[b], index[s]);
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty())
+                low[calls.back().first] = min(low[calls.back().first], low[b]);
+            if (low[b] != index[b])
+                continue;
+            int x;
+            do {
+                x = stack.back();
+                stack.pop_back();
+                on_stack[x] = false;
+                comp[x] = nc;
+            } while (x != b);
+            ++nc;
+        }
+    }
+    return nc;
+}
+
+//components with at least this many blocks are solved by parallel sweeps
+const int sweep_min_blocks = 4096;
+//blocks per chunk of a parallel sweep
+const int sweep_chunk_blocks = 512;
+
+//parallel solver: components of the CFG are solved concurrently once every
+//component they depend on is solved, each one by the worklist iteration above.
+//Large components run Jacobi style sweeps split into chunks: first every block
+//meets its inputs, then every block applies its transfer function.
+//Every task works on its own copy of pb, init and meet may only write the meet
+//input of b and transfer only its result, true for gen/kill problems.
+//The fixpoint is the same as the one of the sequential solvers
+template<typename Problem>
+solver_stats solve_parallel(const cfg& g, int entry, flow_direction dir, int boundary, const Problem& pb, thread_pool& pool)
+{
+    int n = g.size();
+    vector<int> order = reverse_postorder(g, entry);
+    if (dir == BACKWARD)
+        reverse(order.begin(), order.end());
+    vector<int> pos(n);
+    for (int i = 0; i < n; ++i)
+        pos[order[i]] = i;
+    vector<int> comp;
+    int nc = strong_components(g, comp);
+
+    //members of every component as sorted positions, and the dependencies between components
+    vector<vector<int> > members(nc), dependents(nc);
+    for (int i = 0; i < n; ++i)
+        if (order[i] != boundary)
+            members[comp[order[i]]].push_back(i);
+    unique_ptr<atomic<int>[]> waiting(new atomic<int>[nc]);
+    vector<int> stamp(nc, -1);
+    for (int c = 0; c < nc; ++c) {
+        waiting[c] = 0;
+        for (auto i : members[c])
+            for (auto s : dir == FORWARD ? g.pred(order[i]) : g.succ(order[i]))
+                if (s != boundary && comp[s] != c && stamp[comp[s]] != c) {
+                    stamp[comp[s]] = c;
+                    dependents[comp[s]].push_back(c);
+                    ++waiting[c];
+                }
+    }
+
+    solver_stats stats = {0, 0};
+    mutex stats_m;
+    vector<char> queued(n, false);
+    function<void(int)> solve_comp = [&](int c) {
+        solver_stats st = {0, 0};
+        const vector<int> &mem = members[c];
+        int m = mem.size();
+        if (m >= sweep_min_blocks && pool.size() > 1) {
+            int chunks = (m + sweep_chunk_blocks - 1) / sweep_chunk_blocks;
+            atomic<bool> change(true);
+            while (change) {
+                change = false;
+                ++st.iterations;
+                st.visits += m;
+                pool.parallel_for(chunks, [&](int k) {
+                    Problem local = pb;
+                    for (int j = k * sweep_chunk_blocks; j < min(m, (k + 1) * sweep_chunk_blocks); ++j) {
+                        int b = order[mem[j]];
+                        local.init(b);
+                        for (auto s : dir == FORWARD ? g.pred(b) : g.succ(b))
+                            local.meet(b, s);
+                    }
+                });
+                pool.parallel_for(chunks, [&](int k) {
+                    Problem local = pb;
+                    bool changed = false;
+                    for (int j = k * sweep_chunk_blocks; j < min(m, (k + 1) * sweep_chunk_blocks); ++j)
+                        if (local.transfer(order[mem[j]]))
+                            changed = true;
+                    if (changed)
+                        change = true;
+                });
+            }
+        } else {
+            Problem local = pb;
+            worklist_run(g, order, pos, dir, boundary, local, mem, [&](int t){return comp[t] == c;}, queued, st);
+        }
+        {
+            lock_guard<mutex> lock(stats_m);
+            stats.iterations = max(stats.iterations, st.iterations);
+            stats.visits += st.visits;
+        }
+        for (auto d : dependents[c])
+            if (--waiting[d] == 0)
+                pool.submit([&solve_comp, d]{solve_comp(d);});
+    };
+    //collect the roots first, running tasks already release their dependents
+    vector<int> roots;
+    for (int c = 0; c < nc; ++c)
+        if (waiting[c] == 0 && !members[c].empty())
+            roots.push_back(c);
+    for (auto c : roots)
+        pool.submit([&solve_comp, c]{solve_comp(c);});
+    pool.wait();
+    return stats;
+}
+
+//incremental solver: the results in pb are the fixpoint from before the transfer
+//functions of the changed blocks were replaced. When results can only grow the
+//worklist iteration goes on from the changed blocks. Otherwise components of the
+//CFG are taken in flow order, and in a component with a changed block or input the
+//blocks reachable from them are reset and solved again, as a stale fact could keep
+//itself alive around a loop. A later component is only visited when a result
+//flowing into it has changed. The fixpoint is the same as the one of a full solve
+template<typename Problem>
+solver_stats solve_incremental(const cfg& g, int entry, flow_direction dir, int boundary, Problem& pb,
+                               const vector<int>& changed)
+{
+    solver_stats stats = {0, 0};
+    int n = g.size();
+    vector<int> order = reverse_postorder(g, entry);
+    if (dir == BACKWARD)
+        reverse(order.begin(), order.end());
+    vector<int> pos(n);
+    for (int i = 0; i < n; ++i)
+        pos[order[i]] = i;
+    vector<char> queued(n, false);
+    vector<int> start;
+    if (pb.grow_only()) {
+        for (auto b : changed)
+            if (b != boundary)
+                start.push_back(pos[b]);
+        worklist_run(g, order, pos, dir, boundary, pb, start, [](int){return true;}, queued, stats);
+        return stats;
+    }
+    vector<int> comp;
+    int nc = strong_components(g, comp);
+    //blocks of every component whose transfer function or input has changed
+    vector<vector<int> > seeds(nc);
+    for (auto b : changed)
+        if (b != boundary)
+            seeds[comp[b]].push_back(b);
+    vector<char> region(n, false);
+    vector<int> members, stack;
+    //components are numbered sinks first
+    for (int k = 0; k < nc; ++k) {
+        int c = dir == FORWARD ? nc - 1 - k : k;
+        if (seeds[c].empty())
+            continue;
+        //the blocks of c reachable from the seeds
+        members.clear();
+        for (auto b : seeds[c])
+            if (!region[b]) {
+                region[b] = true;
+                stack.push_back(b);
+            }
+        while (!stack.empty()) {
+            int b = stack.back();
+            stack.pop_back();
+            members.push_back(b);
+            for (auto t : dir == FORWARD ? g.succ(b) : g.pred(b))
+                if (t != boundary && comp[t] == c && !region[t]) {
+                    region[t] = true;
+                    stack.push_back(t);
+                }
+        }
+        start.clear();
+        for (auto b : members) {
+            pb.reset(b);
+            start.push_back(pos[b]);
+        }
+        worklist_run(g, order, pos, dir, boundary, pb, start, [&](int t){return region[t] != 0;}, queued, stats);
+        for (auto b : members) {
+            region[b] = false;
+            if (!pb.changed(b))
+                continue;
+            for (auto t : dir == FORWARD ? g.succ(b) : g.pred(b))
+                if (t != boundary && comp[t] != c)
+                    seeds[comp[t]].push_back(t);
+        }
+    }
+    return stats;
+}
+
+//round-robin solver: sweeps all blocks in index order until nothing changes,
+//trace(iteration) is called after every sweep, the -RD -LV -DC dumps are defined by it
+template<typename Problem, typename Trace>
+solver_stats solve_round_robin(const cfg& g, flow_direction dir, int boundary, Problem& pb, Trace trace)
+{
+    solver_stats stats = {0, 0};
+    int n = g.size();
+    bool change = true;
+    while (change) {
+        change = false;
+        for (int b = 0; b < n; ++b) {
+            if (b == boundary)
+                continue;
+            ++stats.visits;
+            pb.init(b);
+            for (auto s : dir == FORWARD ? g.pred(b) : g.succ(b))
+                pb.meet(b, s);
+            if (pb.transfer(b))
+                change = true;
+        }
+        trace(++stats.iterations);
+    }
+    return stats;
+}
+
+#endif
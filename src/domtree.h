@@ -0,0 +1,149 @@
+#ifndef DOMTREE_H
+#define DOMTREE_H
+
+#include <vector>
+#include "cfg.h"
+#include "dataflow.h"
+#include "traverse.h"
+
+using namespace std;
+
+//immediate dominators by the iterative algorithm of Cooper, Harvey and Kennedy:
+//blocks are visited in reverse postorder and the dominators of two preds are
+//intersected by walking up the partial tree by postorder number.
+//idom[entry] and the idom of blocks not reachable from entry are -1
+inline vector<int> immediate_dominators(const cfg& g, int entry, solver_stats *stats = NULL)
+{
+    int n = g.size();
+    vector<int> order = reverse_postorder(g, entry);
+    vector<int> num(n), idom(n, -1);
+    for (int i = 0; i < n; ++i)
+        num[order[i]] = i;
+    idom[entry] = entry;
+    int iterations = 0;
+    long visits = 0;
+    bool change = true;
+    while (change) {
+        change = false;
+        ++iterations;
+        for (auto b : order) {
+            if (b == entry)
+                continue;
+            ++visits;
+            int d = -1;
+            for (auto p : g.pred(b)) {
+                if (idom[p] == -1)
+                    continue;
+                if (d == -1) {
+                    d = p;
+                    continue;
+                }
+                int a = p;
+                while (a != d) {
+                    while (num[a] > num[d])
+                        a = idom[a];
+                    while (num[d] > num[a])
+                        d = idom[d];
+                }
+            }
+            if (d != idom[b]) {
+                idom[b] = d;
+                change = true;
+            }
+        }
+    }
+    idom[entry] = -1;
+    if (stats) {
+        stats->iterations = iterations;
+        stats->visits = visits;
+    }
+    return idom;
+}
+
+//dominator tree with a preorder and postorder interval per block,
+//so dominance is two comparisons and the p x p dominator sets are never built.
+//Children are kept in increasing block order
+class domtree
+{
+
+private:
+    vector<int> idom_, depth_, pre_, post_;
+    //children of b are child_[child_begin_[b], child_begin_[b + 1])
+    vector<int> child_begin_, child_;
+
+public:
+    //build from the preds of the graph
+    void build(const cfg& g, int entry, solver_stats *stats = NULL)
+    {
+        build(immediate_dominators(g, entry, stats), entry);
+    }
+
+    //build from known immediate dominators, -1 for entry and unreachable blocks
+    void build(const vector<int>& idom, int entry)
+    {
+        idom_ = idom;
+        int n = idom_.size();
+        child_begin_.assign(n + 1, 0);
+        for (int b = 0; b < n; ++b)
+            if (idom_[b] != -1)
+                ++child_begin_[idom_[b] + 1];
+        for (int b = 0; b < n; ++b)
+            child_begin_[b + 1] += child_begin_[b];
+        child_.resize(child_begin_[n]);
+        vector<int> fill(child_begin_.begin(), child_begin_.end() - 1);
+        for (int b = 0; b < n; ++b)
+            if (idom_[b] != -1)
+                child_[fill[idom_[b]]++] = b;
+        //number the tree, blocks outside it keep -1
+        depth_.assign(n, -1);
+        pre_.assign(n, -1);
+        post_.assign(n, -1);
+        int pre_num = 0, post_num = 0;
+        depth_[entry] = 0;
+        tree_walk(entry, [&](int b){ return children(b); },
+            [&](int b){
+                if (b != entry)
+                    depth_[b] = depth_[idom_[b]] + 1;
+                pre_[b] = pre_num++;
+            },
+            [&](int b){ post_[b] = post_num++; });
+    }
+
+    int size() const { return idom_.size(); }
+
+    //-1 for the entry and blocks not reachable from it
+    int idom(int b) const { return idom_[b]; }
+
+    bool reachable(int b) const { return pre_[b] != -1; }
+
+    int depth(int b) const { return depth_[b]; }
+
+    //position in a preorder walk of the tree, -1 for unreachable blocks
+    int preorder(int b) const { return pre_[b]; }
+
+    block_range children(int b) const { return block_range(child_.data() + child_begin_[b], child_.data() + child_begin_[b + 1]); }
+
+    //a dominates b, every block dominates an unreachable one as with dominator sets
+    bool dominates(int a, int b) const
+    {
+        if (!reachable(b))
+            return true;
+        return reachable(a) && pre_[a] <= pre_[b] && post_[b] <= post_[a];
+    }
+
+    //nearest common dominator of two reachable blocks
+    int nca(int a, int b) const
+    {
+        while (depth_[a] > depth_[b])
+            a = idom_[a];
+        while (depth_[b] > depth_[a])
+            b = idom_[b];
+        while (a != b) {
+            a = idom_[a];
+            b = idom_[b];
+        }
+        return a;
+    }
+};
+
+#endif
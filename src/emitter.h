@@ -0,0 +1,72 @@
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <iostream>
+#include <vector>
+#include "strview.h"
+
+using namespace std;
+
+//one part of the output in one format (text, dot, TeX, JSON...): the passes
+//it prints and how it is written. Parts are written one after another in the
+//order they were requested, all into the same buffered stream
+class emitter
+{
+
+private:
+    vector<int> needs_;
+
+public:
+    emitter(const vector<int>& needs) : needs_(needs) {}
+
+    virtual ~emitter() {}
+
+    //passes that must have run before emit
+    const vector<int>& needs() const { return needs_; }
+
+    virtual void emit(ostream& os) = 0;
+};
+
+//s as a JSON string literal, quotes included
+class json_string_printer
+{
+
+private:
+    strview s_;
+
+public:
+    json_string_printer(strview s) : s_(s) {}
+
+    friend std::ostream& operator<<(std::ostream& os, const json_string_printer& mp)
+    {
+        static const char hex[] = "0123456789abcdef";
+        strview s = mp.s_;
+        os << '"';
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); ++i) {
+            unsigned char c = s[i];
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+            os << s.substr(run, i - run);
+            run = i + 1;
+            if (c == '"' || c == '\\')
+                os << '\\' << (char)c;
+            else if (c == '\n')
+                os << "\\n";
+            else if (c == '\t')
+                os << "\\t";
+            else if (c == '\r')
+                os << "\\r";
+            else
+                os << "\\u00" << hex[c >> 4] << hex[c & 15];
+        }
+        return os << s.substr(run) << '"';
+    }
+};
+
+inline json_string_printer print_json_string(strview s)
+{
+    return json_string_printer(s);
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef FIXEDSET_H
+#define FIXEDSET_H
+
+#include <iostream>
+#include <algorithm>
+#include <assert.h>
+#include "bitvector.h"
+
+using namespace std;
+
+//bit set of at most N bits stored inline, for the sets of small CFGs:
+//no heap allocation and set operations unroll to a few word instructions.
+//The interface mirrors bitvector.
+template<unsigned N>
+class fixedset
+{
+
+public:
+    typedef bitvector::word word;
+    typedef bitvector::reference reference;
+    typedef bitvector::const_iterator const_iterator;
+
+    static const unsigned word_bits = bitvector::word_bits;
+    static const unsigned nwords = (N + word_bits - 1) / word_bits;
+
+private:
+    word w[nwords];
+    unsigned nbits;
+
+    //bits past nbits are always kept zero
+    void clear_tail()
+    {
+        for (unsigned i = 0; i < nwords; ++i) {
+            unsigned lo = i * word_bits;
+            if (lo >= nbits)
+                w[i] = 0;
+            else if (nbits - lo < word_bits)
+                w[i] &= (word(1) << (nbits - lo)) - 1;
+        }
+    }
+
+public:
+    fixedset(unsigned a = 0, bool b = false) : nbits(a)
+    {
+        assert(a <= N);
+        fill(b);
+    }
+
+    unsigned size() const { return nbits; }
+
+    void fill(bool b)
+    {
+        for (unsigned i = 0; i < nwords; ++i)
+            w[i] = b ? ~word(0) : word(0);
+        clear_tail();
+    }
+
+    const_iterator begin() const { return const_iterator(w, w + nwords); }
+
+    const_iterator end() const { return const_iterator(w + nwords, w + nwords); }
+
+    //index of the lowest set bit or -1
+    int find_first() const
+    {
+        for (unsigned i = 0; i < nwords; ++i)
+            if (w[i])
+                return i * word_bits + __builtin_ctzll(w[i]);
+        return -1;
+    }
+
+    reference operator[](int i) { return reference(&w[i / word_bits], i % word_bits); }
+
+    bool operator[](int i) const { return (w[i / word_bits] >> (i % word_bits)) & 1; }
+
+    //in place operations keep the semantics of a = a op b, the result is min(size) bits long
+    fixedset& operator|=(const fixedset& other)
+    {
+        nbits = min(nbits, other.nbits);
+        for (unsigned i = 0; i < nwords; ++i)
+            w[i] |= other.w[i];
+        clear_tail();
+        return *this;
+    }
+
+    fixedset& operator-=(const fixedset& other)
+    {
+        nbits = min(nbits, other.nbits);
+        for (unsigned i = 0; i < nwords; ++i)
+            w[i] &= ~other.w[i];
+        clear_tail();
+        return *this;
+    }
+
+    fixedset& operator&=(const fixedset& other)
+    {
+        nbits = min(nbits, other.nbits);
+        for (unsigned i = 0; i < nwords; ++i)
+            w[i] &= other.w[i];
+        clear_tail();
+        return *this;
+    }
+
+    //*this = gen | (in & ~kill), returns true if *this has changed
+    bool assign_transfer(const fixedset& gen, const fixedset& in, const fixedset& kill)
+    {
+        fixedset tmp = gen + (in - kill);
+        bool changed = !(tmp == *this);
+        *this = tmp;
+        return changed;
+    }
+
+    friend const fixedset operator+(const fixedset& left, const fixedset& right)
+    {
+        fixedset tmp = left;
+        return tmp |= right;
+    }
+
+    friend const fixedset operator-(const fixedset& left, const fixedset& right)
+    {
+        fixedset tmp = left;
+        return tmp -= right;
+    }
+
+    friend const fixedset operator*(const fixedset& left, const fixedset& right)
+    {
+        fixedset tmp = left;
+        return tmp &= right;
+    }
+
+    friend bool operator==(const fixedset& left, const fixedset& right)
+    {
+        if (left.nbits != right.nbits)
+            return false;
+        for (unsigned i = 0; i < nwords; ++i)
+            if (left.w[i] != right.w[i])
+                return false;
+        return true;
+    }
+
+    friend ostream& operator<<(ostream& os, const fixedset& d)
+    {
+        //bit mask
+        for (unsigned i = 0; i < d.nbits; ++i)
+            os << (int)d[i];
+        return os;
+    }
+};
+
+#endif
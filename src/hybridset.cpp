@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <iterator>
+#include "hybridset.h"
+
+namespace {
+
+unsigned popcount(const vector<hybridset::word>& w)
+{
+	unsigned n = 0;
+	for (auto x : w)
+		n += __builtin_popcountll(x);
+	return n;
+}
+
+}
+
+const unsigned hybridset::chunk_bits;
+
+hybridset::hybridset(unsigned a, bool b) : nbits(a)
+{
+	fill(b);
+}
+
+int hybridset::find_chunk(unsigned key) const
+{
+	auto it = lower_bound(chunks.begin(), chunks.end(), key, [](const chunk& c, unsigned k){return c.key < k;});
+	if (it == chunks.end() || it->key != key)
+		return -1;
+	return it - chunks.begin();
+}
+
+//keep arrays for light chunks and bitmaps for heavy ones, so equal sets have equal chunks
+void hybridset::normalize(chunk& c)
+{
+	if (c.dense() && c.card <= array_max) {
+		c.array.clear();
+		for (unsigned i = 0; i < chunk_words; ++i)
+			for (word w = c.bitmap[i]; w; w &= w - 1)
+				c.array.push_back(i * 64 + __builtin_ctzll(w));
+		vector<word>().swap(c.bitmap);
+	} else if (!c.dense() && c.card > array_max) {
+		c.bitmap.assign(chunk_words, 0);
+		for (auto i : c.array)
+			c.bitmap[i / 64] |= word(1) << (i % 64);
+		vector<uint16_t>().swap(c.array);
+	}
+}
+
+bool hybridset::chunk_test(const chunk& c, unsigned low)
+{
+	if (c.dense())
+		return (c.bitmap[low / 64] >> (low % 64)) & 1;
+	return binary_search(c.array.begin(), c.array.end(), (uint16_t)low);
+}
+
+void hybridset::chunk_or(chunk& a, const chunk& b)
+{
+	if (!a.dense() && !b.dense()) {
+		vector<uint16_t> tmp;
+		tmp.reserve(a.array.size() + b.array.size());
+		set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), back_inserter(tmp));
+		a.array.swap(tmp);
+		a.card = a.array.size();
+	} else {
+		if (!a.dense()) {
+			vector<uint16_t> tmp;
+			tmp.swap(a.array);
+			a.bitmap = b.bitmap;
+			for (auto i : tmp)
+				a.bitmap[i / 64] |= word(1) << (i % 64);
+		} else if (!b.dense()) {
+			for (auto i : b.array)
+				a.bitmap[i / 64] |= word(1) << (i % 64);
+		} else
+			for (unsigned i = 0; i < chunk_words; ++i)
+				a.bitmap[i] |= b.bitmap[i];
+		a.card = popcount(a.bitmap);
+	}
+	normalize(a);
+}
+
+void hybridset::chunk_andnot(chunk& a, const chunk& b)
+{
+	if (!a.dense()) {
+		vector<uint16_t> tmp;
+		if (!b.dense())
+			set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), back_inserter(tmp));
+		else
+			for (auto i : a.array)
+				if (!chunk_test(b, i))
+					tmp.push_back(i);
+		a.array.swap(tmp);
+		a.card = a.array.size();
+	} else {
+		if (!b.dense())
+			for (auto i : b.array)
+				a.bitmap[i / 64] &= ~(word(1) << (i % 64));
+		else
+			for (unsigned i = 0; i < chunk_words; ++i)
+				a.bitmap[i] &= ~b.bitmap[i];
+		a.card = popcount(a.bitmap);
+	}
+	normalize(a);
+}
+
+void hybridset::chunk_and(chunk& a, const chunk& b)
+{
+	if (!a.dense()) {
+		vector<uint16_t> tmp;
+		if (!b.dense())
+			set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), back_inserter(tmp));
+		else
+			for (auto i : a.array)
+				if (chunk_test(b, i))
+					tmp.push_back(i);
+		a.array.swap(tmp);
+		a.card = a.array.size();
+	} else if (!b.dense()) {
+		vector<uint16_t> tmp;
+		for (auto i : b.array)
+			if (chunk_test(a, i))
+				tmp.push_back(i);
+		vector<word>().swap(a.bitmap);
+		a.array.swap(tmp);
+		a.card = a.array.size();
+	} else {
+		for (unsigned i = 0; i < chunk_words; ++i)
+			a.bitmap[i] &= b.bitmap[i];
+		a.card = popcount(a.bitmap);
+	}
+	normalize(a);
+}
+
+//drop members >= n, operations keep the semantics of bitvector where the result is min(size) bits long
+void hybridset::truncate(unsigned n)
+{
+	nbits = n;
+	while (!chunks.empty() && chunks.back().key * chunk_bits >= n)
+		chunks.pop_back();
+	if (chunks.empty() || chunks.back().key * chunk_bits + chunk_bits <= n)
+		return;
+	chunk& c = chunks.back();
+	unsigned low = n % chunk_bits;
+	if (c.dense()) {
+		for (unsigned i = low; i < chunk_bits; ++i)
+			c.bitmap[i / 64] &= ~(word(1) << (i % 64));
+		c.card = popcount(c.bitmap);
+	} else {
+		c.array.erase(lower_bound(c.array.begin(), c.array.end(), low), c.array.end());
+		c.card = c.array.size();
+	}
+	if (c.card == 0)
+		chunks.pop_back();
+	else
+		normalize(c);
+}
+
+unsigned hybridset::count() const
+{
+	unsigned n = 0;
+	for (auto &c : chunks)
+		n += c.card;
+	return n;
+}
+
+bool hybridset::test(unsigned i) const
+{
+	int k = find_chunk(i / chunk_bits);
+	return k >= 0 && chunk_test(chunks[k], i % chunk_bits);
+}
+
+void hybridset::set(unsigned i, bool b)
+{
+	unsigned key = i / chunk_bits, low = i % chunk_bits;
+	auto it = lower_bound(chunks.begin(), chunks.end(), key, [](const chunk& c, unsigned k){return c.key < k;});
+	if (it == chunks.end() || it->key != key) {
+		if (!b)
+			return;
+		it = chunks.insert(it, chunk());
+		it->key = key;
+		it->card = 0;
+	}
+	chunk& c = *it;
+	if (chunk_test(c, low) == b)
+		return;
+	if (c.dense()) {
+		if (b)
+			c.bitmap[low / 64] |= word(1) << (low % 64);
+		else
+			c.bitmap[low / 64] &= ~(word(1) << (low % 64));
+	} else {
+		auto pos = lower_bound(c.array.begin(), c.array.end(), low);
+		if (b)
+			c.array.insert(pos, low);
+		else
+			c.array.erase(pos);
+	}
+	if (b)
+		++c.card;
+	else
+		--c.card;
+	if (c.card == 0)
+		chunks.erase(it);
+	else
+		normalize(c);
+}
+
+void hybridset::fill(bool b)
+{
+	chunks.clear();
+	if (!b)
+		return;
+	for (unsigned key = 0; key * chunk_bits < nbits; ++key) {
+		chunk c;
+		c.key = key;
+		c.card = min(chunk_bits, nbits - key * chunk_bits);
+		c.bitmap.assign(chunk_words, 0);
+		for (unsigned i = 0; i < c.card; ++i)
+			c.bitmap[i / 64] |= word(1) << (i % 64);
+		normalize(c);
+		chunks.push_back(c);
+	}
+}
+
+hybridset& hybridset::operator|=(const hybridset& other)
+{
+	unsigned n = min(nbits, other.nbits);
+	vector<chunk> tmp;
+	tmp.reserve(chunks.size() + other.chunks.size());
+	auto a = chunks.begin();
+	auto b = other.chunks.begin();
+	while (a != chunks.end() || b != other.chunks.end()) {
+		if (b == other.chunks.end() || (a != chunks.end() && a->key < b->key))
+			tmp.push_back(move(*a++));
+		else if (a == chunks.end() || b->key < a->key)
+			tmp.push_back(*b++);
+		else {
+			chunk_or(*a, *b++);
+			tmp.push_back(move(*a++));
+		}
+	}
+	chunks.swap(tmp);
+	truncate(n);
+	return *this;
+}
+
+hybridset& hybridset::operator-=(const hybridset& other)
+{
+	unsigned n = min(nbits, other.nbits);
+	vector<chunk> tmp;
+	tmp.reserve(chunks.size());
+	auto b = other.chunks.begin();
+	for (auto &a : chunks) {
+		while (b != other.chunks.end() && b->key < a.key)
+			++b;
+		if (b != other.chunks.end() && b->key == a.key)
+			chunk_andnot(a, *b);
+		if (a.card)
+			tmp.push_back(move(a));
+	}
+	chunks.swap(tmp);
+	truncate(n);
+	return *this;
+}
+
+hybridset& hybridset::operator&=(const hybridset& other)
+{
+	unsigned n = min(nbits, other.nbits);
+	vector<chunk> tmp;
+	auto b = other.chunks.begin();
+	for (auto &a : chunks) {
+		while (b != other.chunks.end() && b->key < a.key)
+			++b;
+		if (b == other.chunks.end() || b->key != a.key)
+			continue;
+		chunk_and(a, *b);
+		if (a.card)
+			tmp.push_back(move(a));
+	}
+	chunks.swap(tmp);
+	truncate(n);
+	return *this;
+}
+
+bool hybridset::assign_transfer(const hybridset& gen, const hybridset& in, const hybridset& kill)
+{
+	hybridset tmp = in;
+	tmp -= kill;
+	tmp |= gen;
+	if (tmp == *this)
+		return false;
+	chunks.swap(tmp.chunks);
+	nbits = tmp.nbits;
+	return true;
+}
+
+const hybridset operator+(const hybridset& left, const hybridset& right)
+{
+	hybridset tmp = left;
+	return tmp |= right;
+}
+
+const hybridset operator-(const hybridset& left, const hybridset& right)
+{
+	hybridset tmp = left;
+	return tmp -= right;
+}
+
+const hybridset operator*(const hybridset& left, const hybridset& right)
+{
+	hybridset tmp = left;
+	return tmp &= right;
+}
+
+bool operator==(const hybridset& left, const hybridset& right)
+{
+	if (left.nbits != right.nbits || left.chunks.size() != right.chunks.size())
+		return false;
+	for (size_t i = 0; i < left.chunks.size(); ++i) {
+		const hybridset::chunk &a = left.chunks[i], &b = right.chunks[i];
+		if (a.key != b.key || a.card != b.card || a.array != b.array || a.bitmap != b.bitmap)
+			return false;
+	}
+	return true;
+}
+
+ostream& operator<<(ostream& os, const hybridset& d)
+{
+	//bit mask
+	for (unsigned i = 0; i < d.nbits; ++i)
+		os << (int)d.test(i);
+	return os;
+}
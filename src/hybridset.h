@@ -0,0 +1,184 @@
+#ifndef HYBRIDSET_H
+#define HYBRIDSET_H
+
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+//bit set split into 2^16 bit chunks, in the style of roaring bitmaps:
+//light chunks keep a sorted array of their members, heavy chunks a plain bitmap
+//and empty chunks are not stored at all, so memory and set operations scale
+//with the number of set bits rather than with the universe size.
+//The interface mirrors bitvector.
+class hybridset
+{
+
+public:
+    typedef uint64_t word;
+
+    static const unsigned chunk_bits = 1 << 16;
+    static const unsigned chunk_words = chunk_bits / 64;
+    //chunks with more members than this are stored as bitmaps
+    static const unsigned array_max = 4096;
+
+private:
+    struct chunk
+    {
+        unsigned key, card;
+        vector<uint16_t> array;
+        vector<word> bitmap;
+
+        bool dense() const { return !bitmap.empty(); }
+    };
+
+    //sorted by key, none of them is empty
+    vector<chunk> chunks;
+    unsigned nbits;
+
+    int find_chunk(unsigned key) const;
+
+    void truncate(unsigned n);
+
+    static void normalize(chunk& c);
+
+    static bool chunk_test(const chunk& c, unsigned low);
+
+    static void chunk_or(chunk& a, const chunk& b);
+
+    static void chunk_andnot(chunk& a, const chunk& b);
+
+    static void chunk_and(chunk& a, const chunk& b);
+
+public:
+    class reference
+    {
+
+    private:
+        hybridset *s_;
+        unsigned i_;
+
+    public:
+        reference(hybridset *s, unsigned i) : s_(s), i_(i) {}
+
+        operator bool() const { return s_->test(i_); }
+
+        reference& operator=(bool b)
+        {
+            s_->set(i_, b);
+            return *this;
+        }
+
+        reference& operator=(const reference& other) { return *this = bool(other); }
+    };
+
+    //walks the indexes of set bits in increasing order
+    class const_iterator
+    {
+
+    private:
+        const vector<chunk> *c_;
+        size_t ci_;
+        unsigned pos_;
+        word cur_;
+
+        void enter_chunk()
+        {
+            pos_ = 0;
+            cur_ = ci_ < c_->size() && (*c_)[ci_].dense() ? (*c_)[ci_].bitmap[0] : 0;
+        }
+
+        void settle()
+        {
+            while (ci_ < c_->size()) {
+                const chunk& c = (*c_)[ci_];
+                if (!c.dense()) {
+                    if (pos_ < c.array.size())
+                        return;
+                } else {
+                    while (cur_ == 0 && ++pos_ < chunk_words)
+                        cur_ = c.bitmap[pos_];
+                    if (cur_)
+                        return;
+                }
+                ++ci_;
+                enter_chunk();
+            }
+        }
+
+    public:
+        const_iterator(const vector<chunk> *c, size_t ci) : c_(c), ci_(ci)
+        {
+            enter_chunk();
+            settle();
+        }
+
+        int operator*() const
+        {
+            const chunk& c = (*c_)[ci_];
+            if (!c.dense())
+                return c.key * chunk_bits + c.array[pos_];
+            return c.key * chunk_bits + pos_ * 64 + __builtin_ctzll(cur_);
+        }
+
+        const_iterator& operator++()
+        {
+            if (!(*c_)[ci_].dense())
+                ++pos_;
+            else
+                cur_ &= cur_ - 1;
+            settle();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return ci_ == other.ci_ && pos_ == other.pos_ && cur_ == other.cur_; }
+
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+
+    hybridset(unsigned a = 0, bool b = false);
+
+    unsigned size() const { return nbits; }
+
+    //number of set bits
+    unsigned count() const;
+
+    bool test(unsigned i) const;
+
+    void set(unsigned i, bool b = true);
+
+    void fill(bool b);
+
+    const_iterator begin() const { return const_iterator(&chunks, 0); }
+
+    const_iterator end() const { return const_iterator(&chunks, chunks.size()); }
+
+    //index of the lowest set bit or -1
+    int find_first() const { return chunks.empty() ? -1 : *begin(); }
+
+    reference operator[](int i) { return reference(this, i); }
+
+    bool operator[](int i) const { return test(i); }
+
+    hybridset& operator|=(const hybridset& other);
+
+    hybridset& operator-=(const hybridset& other);
+
+    hybridset& operator&=(const hybridset& other);
+
+    //*this = gen | (in & ~kill), returns true if *this has changed
+    bool assign_transfer(const hybridset& gen, const hybridset& in, const hybridset& kill);
+
+    friend const hybridset operator+(const hybridset& left, const hybridset& right);
+
+    friend const hybridset operator-(const hybridset& left, const hybridset& right);
+
+    friend const hybridset operator*(const hybridset& left, const hybridset& right);
+
+    friend bool operator==(const hybridset& left, const hybridset& right);
+
+    friend ostream& operator<<(ostream& os, const hybridset& d);
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef IDF_H
+#define IDF_H
+
+#include <algorithm>
+#include <vector>
+#include "cfg.h"
+#include "domtree.h"
+
+using namespace std;
+
+//iterated dominance frontier by the piggybank algorithm of Sreedhar and Gao:
+//blocks are taken deepest first and the dominator subtree of each one is walked,
+//a join edge (an edge whose target is not a tree child) to a block no deeper
+//than the root reaches a frontier block. Every block is walked once per set.
+//The buffers are reused across calls, one calculator per thread
+class idf_calculator
+{
+
+private:
+    const cfg& g_;
+    const domtree& tree_;
+    //stamp of the last call a block was queued, walked or placed in
+    vector<int> queued_, walked_, placed_;
+    int stamp_;
+    //queued blocks by depth
+    vector<vector<int> > bank_;
+    vector<int> stack_;
+
+public:
+    idf_calculator(const cfg& g, const domtree& tree) :
+        g_(g), tree_(tree),
+        queued_(tree.size(), 0), walked_(tree.size(), 0), placed_(tree.size(), 0),
+        stamp_(0)
+    {
+        int depth = 0;
+        for (int b = 0; b < tree.size(); ++b)
+            depth = max(depth, tree.depth(b));
+        bank_.resize(depth + 1);
+    }
+
+    //frontier blocks of defs in increasing order into out,
+    //live(b) false drops b and does not follow it further (pruned SSA)
+    template<typename Live>
+    void calculate(const vector<int>& defs, Live live, vector<int>& out)
+    {
+        out.clear();
+        ++stamp_;
+        int level = -1;
+        for (auto b : defs) {
+            if (!tree_.reachable(b) || queued_[b] == stamp_)
+                continue;
+            queued_[b] = stamp_;
+            bank_[tree_.depth(b)].push_back(b);
+            level = max(level, tree_.depth(b));
+        }
+        for (;;) {
+            while (level >= 0 && bank_[level].empty())
+                --level;
+            if (level < 0)
+                break;
+            int root = bank_[level].back();
+            bank_[level].pop_back();
+            walked_[root] = stamp_;
+            stack_.push_back(root);
+            while (!stack_.empty()) {
+                int x = stack_.back();
+                stack_.pop_back();
+                for (auto y : g_.succ(x)) {
+                    if (tree_.idom(y) == x || !tree_.reachable(y) || tree_.depth(y) > level)
+                        continue;
+                    if (placed_[y] == stamp_)
+                        continue;
+                    placed_[y] = stamp_;
+                    if (!live(y))
+                        continue;
+                    out.push_back(y);
+                    if (queued_[y] != stamp_) {
+                        queued_[y] = stamp_;
+                        bank_[tree_.depth(y)].push_back(y);
+                    }
+                }
+                for (auto c : tree_.children(x))
+                    if (walked_[c] != stamp_) {
+                        walked_[c] = stamp_;
+                        stack_.push_back(c);
+                    }
+            }
+        }
+        sort(out.begin(), out.end());
+    }
+
+    void calculate(const vector<int>& defs, vector<int>& out)
+    {
+        calculate(defs, [](int){ return true; }, out);
+    }
+};
+
+#endif
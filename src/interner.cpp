@@ -0,0 +1,73 @@
+#include <string.h>
+#include "interner.h"
+
+interner::interner()
+{
+	clear();
+}
+
+void interner::clear()
+{
+	arena.clear();
+	offsets.assign(1, 0);
+	hashes.clear();
+	slots.assign(16, -1);
+}
+
+//FNV-1a
+uint32_t interner::hash(const char *s, size_t n)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < n; ++i) {
+		h ^= (unsigned char)s[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+size_t interner::probe(const char *s, size_t n, uint32_t h) const
+{
+	size_t mask = slots.size() - 1;
+	for (size_t i = h & mask;; i = (i + 1) & mask) {
+		int id = slots[i];
+		if (id < 0)
+			return i;
+		if (hashes[id] == h && offsets[id + 1] - offsets[id] == n && memcmp(arena.data() + offsets[id], s, n) == 0)
+			return i;
+	}
+}
+
+void interner::grow()
+{
+	slots.assign(slots.size() * 2, -1);
+	size_t mask = slots.size() - 1;
+	for (size_t id = 0; id < hashes.size(); ++id) {
+		size_t i = hashes[id] & mask;
+		while (slots[i] >= 0)
+			i = (i + 1) & mask;
+		slots[i] = id;
+	}
+}
+
+int interner::intern(const char *s, size_t n)
+{
+	uint32_t h = hash(s, n);
+	size_t i = probe(s, n, h);
+	if (slots[i] >= 0)
+		return slots[i];
+	int id = hashes.size();
+	arena.insert(arena.end(), s, s + n);
+	offsets.push_back(arena.size());
+	hashes.push_back(h);
+	slots[i] = id;
+	//keep the load factor under one half
+	if (2 * hashes.size() > slots.size())
+		grow();
+	return id;
+}
+
+int interner::find(strview s) const
+{
+	size_t i = probe(s.s, s.n, hash(s.s, s.n));
+	return slots[i];
+}
@@ -0,0 +1,51 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "strview.h"
+
+using namespace std;
+
+//maps names to dense ids in order of first appearance: the characters of all names
+//live in one arena and an open addressing hash table finds the id of a name
+class interner
+{
+
+private:
+    vector<char> arena;
+    //name id spans arena[offsets[id], offsets[id + 1])
+    vector<size_t> offsets;
+    vector<uint32_t> hashes;
+    //ids, -1 for a free slot, the size is a power of two
+    vector<int> slots;
+
+    static uint32_t hash(const char *s, size_t n);
+
+    //slot holding the name or the free slot where it belongs
+    size_t probe(const char *s, size_t n, uint32_t h) const;
+
+    void grow();
+
+public:
+    interner();
+
+    size_t size() const { return hashes.size(); }
+
+    //id of the name, added if it is new
+    int intern(const char *s, size_t n);
+
+    int intern(strview s) { return intern(s.s, s.n); }
+
+    //id of the name or -1
+    int find(strview s) const;
+
+    //the name in the arena, valid until the next intern
+    strview operator[](int id) const { return strview(arena.data() + offsets[id], offsets[id + 1] - offsets[id]); }
+
+    void clear();
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef LOOPS_H
+#define LOOPS_H
+
+#include <algorithm>
+#include <vector>
+#include "cfg.h"
+#include "domtree.h"
+#include "traverse.h"
+
+using namespace std;
+
+struct loop
+{
+    int header;
+    //enclosing loop, -1 for an outermost one, depth 1 for outermost loops
+    int parent, depth;
+    //blocks whose innermost loop this is, in increasing order
+    vector<int> blocks;
+    //sources of the back edges to header, in increasing order
+    vector<int> latches;
+    //nested loops by header
+    vector<int> children;
+    //edges leaving the loop or any loop nested in it
+    vector<pair<int, int> > exits;
+};
+
+//natural loops nested into a forest: back edges to the same header make one loop.
+//Headers are taken deepest in the dominator tree first and each one walks back
+//from its latches; a block already in a loop jumps to the header of its outermost
+//loop so far, which becomes a child of the current one, so every block is walked
+//about once. Edges from blocks not reachable from entry are ignored
+class loop_forest
+{
+
+private:
+    vector<loop> loops_;
+    vector<int> roots_;
+    //innermost loop of each block, -1 outside all loops
+    vector<int> loop_of_;
+    //preorder interval of each loop in the forest
+    vector<int> pre_, last_;
+
+    //the outermost loop found so far that contains loop l
+    int outermost(vector<int>& up, int l)
+    {
+        int r = l;
+        while (up[r] != r)
+            r = up[r];
+        while (up[l] != r) {
+            int n = up[l];
+            up[l] = r;
+            l = n;
+        }
+        return r;
+    }
+
+public:
+    void build(const cfg& g, const domtree& tree)
+    {
+        int n = g.size();
+        loops_.clear();
+        roots_.clear();
+        loop_of_.assign(n, -1);
+        vector<int> headers;
+        for (int h = 0; h < n; ++h) {
+            if (!tree.reachable(h))
+                continue;
+            for (auto p : g.pred(h))
+                if (tree.reachable(p) && tree.dominates(h, p)) {
+                    headers.push_back(h);
+                    break;
+                }
+        }
+        sort(headers.begin(), headers.end(), [&](int a, int b){ return tree.preorder(a) > tree.preorder(b); });
+        vector<int> up, stack;
+        for (auto h : headers) {
+            int l = loops_.size();
+            loops_.push_back(loop());
+            loops_[l].header = h;
+            loops_[l].parent = -1;
+            up.push_back(l);
+            loop_of_[h] = l;
+            loops_[l].blocks.push_back(h);
+            for (auto p : g.pred(h))
+                if (tree.reachable(p) && tree.dominates(h, p)) {
+                    loops_[l].latches.push_back(p);
+                    stack.push_back(p);
+                }
+            while (!stack.empty()) {
+                int b = stack.back();
+                stack.pop_back();
+                if (loop_of_[b] == -1) {
+                    loop_of_[b] = l;
+                    loops_[l].blocks.push_back(b);
+                } else {
+                    int s = outermost(up, loop_of_[b]);
+                    if (s == l)
+                        continue;
+                    loops_[s].parent = l;
+                    up[s] = l;
+                    b = loops_[s].header;
+                }
+                for (auto p : g.pred(b))
+                    if (tree.reachable(p))
+                        stack.push_back(p);
+            }
+        }
+        //outer loops were found after the loops they contain
+        for (int l = loops_.size() - 1; l >= 0; --l) {
+            loop &x = loops_[l];
+            sort(x.blocks.begin(), x.blocks.end());
+            sort(x.latches.begin(), x.latches.end());
+            x.latches.erase(unique(x.latches.begin(), x.latches.end()), x.latches.end());
+            if (x.parent == -1) {
+                x.depth = 1;
+                roots_.push_back(l);
+            } else {
+                x.depth = loops_[x.parent].depth + 1;
+                loops_[x.parent].children.push_back(l);
+            }
+        }
+        auto by_header = [&](int a, int b){ return loops_[a].header < loops_[b].header; };
+        sort(roots_.begin(), roots_.end(), by_header);
+        for (auto &x : loops_)
+            sort(x.children.begin(), x.children.end(), by_header);
+        pre_.assign(loops_.size(), 0);
+        last_.assign(loops_.size(), 0);
+        int num = 0;
+        for (auto r : roots_)
+            tree_walk(r, [&](int l) -> const vector<int>& { return loops_[l].children; },
+                [&](int l){ pre_[l] = num++; }, [&](int l){ last_[l] = num - 1; });
+        //an edge leaves every loop around its source that does not hold its target
+        for (int b = 0; b < n; ++b)
+            for (auto s : g.succ(b))
+                for (int l = loop_of_[b]; l != -1 && !contains(l, s); l = loops_[l].parent)
+                    loops_[l].exits.push_back(make_pair(b, s));
+    }
+
+    int size() const { return loops_.size(); }
+
+    const loop& operator[](int l) const { return loops_[l]; }
+
+    //outermost loops by header
+    const vector<int>& roots() const { return roots_; }
+
+    int loop_of(int b) const { return loop_of_[b]; }
+
+    //number of loops around b, 0 outside all loops
+    int depth(int b) const { return loop_of_[b] == -1 ? 0 : loops_[loop_of_[b]].depth; }
+
+    //block b is in loop l or a loop nested in it
+    bool contains(int l, int b) const
+    {
+        int m = loop_of_[b];
+        return m != -1 && pre_[l] <= pre_[m] && pre_[m] <= last_[l];
+    }
+
+    //all blocks of loop l and its nested loops in increasing order
+    void members(int l, vector<int>& out) const
+    {
+        out.clear();
+        tree_walk(l, [&](int x) -> const vector<int>& { return loops_[x].children; },
+            [&](int x){ out.insert(out.end(), loops_[x].blocks.begin(), loops_[x].blocks.end()); }, no_visit());
+        sort(out.begin(), out.end());
+    }
+};
+
+#endif
@@ -1,13 +1,36 @@
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <vector>
-#include <map>
 #include <algorithm>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <getopt.h>
 #include <assert.h>
 #include "bitvector.h"
+#include "strview.h"
+#include "interner.h"
+#include "reader.h"
+#include "hybridset.h"
+#include "fixedset.h"
+#include "bitmatrix.h"
+#include "threadpool.h"
+#include "dataflow.h"
+#include "cfg.h"
+#include "domtree.h"
+#include "idf.h"
+#include "loops.h"
+#include "passes.h"
+#include "writer.h"
+#include "emitter.h"
+#include "cache.h"
+#include "server.h"
 
 using namespace std;
 
@@ -21,21 +44,44 @@ enum instype
     LABEL_JUMP
 };
 
+enum opnd_kind
+{
+    NO_OPND,
+    VAR_OPND,
+    IMM_OPND
+};
+
+enum array_form
+{
+    NO_ARRAY,
+    ARRAY_LEFT,  //l_id[r_id1] = r_id2
+    ARRAY_RIGHT  //l_id = r_id1[r_id2]
+};
+
 struct ins
 {
     int ins_id;
-    string str, ins_label;
+    strview str, ins_label; //views into ir_text or the -edit text
     instype type;
     int id, l_id, r_id1, r_id2;
     int bb_id;
     int old_l_id;
+    int def_id; //index in all_def, -1 without left part
+    //structured form, emitters render from it instead of splitting str again
+    strview opcode, oper;
+    opnd_kind kind[3]; //of the l_id, r_id1, r_id2 slots
+    strview imm[3];    //text of IMM_OPND slots
+    array_form array;
 };
 
  /*
-instype:   id:
-LABEL      label_id
-LABEL_JUMP label_id
-other      undef (-1)
+instype:   id:          opcode:   oper:
+LABEL      label_id     label
+LABEL_JUMP label_id     goto      label
+IF         undef (-1)   ifTrue    relation
+ELSE       undef (-1)   else
+EXIT_JUMP  undef (-1)   return
+OP         undef (-1)   =         operator of a binary op
 */
 
 struct phi
@@ -48,45 +94,47 @@ struct bb
 {
     int name_id;
     int first_ins, last_ins;
-    bitvector gen, kill, use, def, in_rd, out_rd, in_lv, out_lv, dom, df;
-    vector<int> pred, succ;
-    int idom;
     vector<phi> phi_list;
-    vector<int> succdom;
 };
 
-vector<ins> ins_list;
-vector<string> labels_names;
-vector<string> bb_names;
-vector<string> var_names;
-vector<bb> bbs;
-vector<tuple<int, int> > all_def;
-int ENTRY_ID, EXIT_ID;
-
-template<typename T>
-int get_index(vector<T> &vec, T s, bool add = false)
-{
-    auto it = find(vec.begin(), vec.end(), s);
-    if (it != vec.end())
-        return it - vec.begin();
-    else if (add) {
-        vec.push_back(s);
-        return vec.size() - 1;
-    } else
-        return -1;
-}
+//the state of one run is kept per thread, so -server workers analyze their requests
+//side by side, and cleared by reset_state between requests.
+//Tasks given to the -j workers must capture what they use from it
+thread_local input_buffer ir_text;
+thread_local vector<ins> ins_list;
+thread_local interner labels_names;
+thread_local vector<string> bb_names;
+thread_local interner var_names;
+thread_local vector<bb> bbs;
+thread_local cfg flow_graph;
+thread_local domtree dom_tree;
+thread_local loop_forest loop_tree;
+thread_local vector<tuple<int, int> > all_def;
+//definitions of every variable
+thread_local vector<vector<int> > var_defs;
+thread_local int ENTRY_ID, EXIT_ID;
+//errors, warnings and -stats, the diagnostics of the request in a -server worker
+thread_local ostream *diag = &cerr;
 
-bool is_number(const string& s)
+//digits, or anything starting with '-'
+bool is_number(strview s)
 {
-    return !s.empty() && (s.find_first_not_of("0123456789") == string::npos || (s.find_first_not_of("0123456789") == 0 && s[0] == '-'));
+    if (s.empty())
+        return false;
+    if (s[0] == '-')
+        return true;
+    for (size_t i = 0; i < s.size(); ++i)
+        if (s[i] < '0' || s[i] > '9')
+            return false;
+    return true;
 }
 
-bool is_array_element(const string& s, string& k1, string& k2)
+bool is_array_element(strview s, strview& k1, strview& k2)
 {
     if (s.empty())
         return false;
-    auto a = s.find_first_of("["), b = s.find_last_of("]");
-    if (a == string::npos || b == string::npos || a == 0 || b < s.size() - 1)
+    auto a = s.find_first_of('['), b = s.find_last_of(']');
+    if (a == strview::npos || b == strview::npos || a == 0 || b < s.size() - 1)
         return false;
     k1 = s.substr(0, a);
     k2 = s.substr(a + 1, b - (a + 1));
@@ -101,93 +149,211 @@ string NumberToString(T Number)
     return ss.str();
 }
 
-int DFST(vector<bool> &a, vector<int>& b, int num = 1)
+//name the bbs reachable from entry BB1, BB2, ... in depth first preorder,
+//bbs marked in a are neither named nor passed through
+void DFST(vector<bool> &a)
 {
-    for (auto i : b) {
-        if (a[i])
-            continue;
-        bb_names[i] = string("BB") + NumberToString(num);
-        a[i] = true;
-        num = DFST(a, bbs[i].succ, num + 1);
-    }
-    return num;
+    int num = 1;
+    depth_first(ENTRY_ID, a, [](int b){ return flow_graph.succ(b); },
+        [&](int b){
+            if (b != ENTRY_ID)
+                bb_names[b] = string("BB") + NumberToString(num++);
+        }, no_visit());
 }
 
-void loops_search(int i, bitvector& a)
+//the set printers keep a reference to the set, they are meant to be
+//streamed in the expression that makes them
+template<typename Set>
+class var_bb_names_printer
 {
-    if (!a[i]) {
-        a[i] = true;
-        for (auto j : bbs[i].pred)
-            loops_search(j, a);
+
+private:
+    const Set& c_;
+
+public:
+    var_bb_names_printer(const Set& c) : c_(c) {}
+
+    friend std::ostream& operator<<(std::ostream& os, const var_bb_names_printer& mp)
+    {
+        for (auto i : mp.c_) {
+            auto &t = all_def[i];
+            os << "(" << var_names[get<1>(t)] << ", " << bb_names[ins_list[get<0>(t)].bb_id] << ") ";
+        }
+        return os;
     }
+};
+
+template<typename Set>
+var_bb_names_printer<Set> print_var_bb_names(const Set& c)
+{
+    return var_bb_names_printer<Set>(c);
 }
 
-class print_var_bb_names
+template<typename Set>
+class var_names_printer
 {
 
 private:
-    bitvector c_;
+    const Set& c_;
 
 public:
-    print_var_bb_names(bitvector c) : c_(c) {}
+    var_names_printer(const Set& c) : c_(c) {}
 
-    friend std::ostream& operator<<(std::ostream& os, const print_var_bb_names& mp)
+    friend std::ostream& operator<<(std::ostream& os, const var_names_printer& mp)
     {
-        for (int i = 0; i < all_def.size(); ++i)
-            if (mp.c_[i]) {
-                auto t = all_def[i];
-                os << "(" << var_names[get<1>(t)] << ", " << bb_names[ins_list[get<0>(t)].bb_id] << ") ";
-            }
+        for (auto i : mp.c_)
+            os << var_names[i] << " ";
         return os;
     }
 };
 
-class print_var_names
+template<typename Set>
+var_names_printer<Set> print_var_names(const Set& c)
+{
+    return var_names_printer<Set>(c);
+}
+
+template<typename Set>
+class bb_names_printer
 {
 
 private:
-    bitvector c_;
+    const Set& c_;
 
 public:
-    print_var_names(bitvector c) : c_(c) {}
+    bb_names_printer(const Set& c) : c_(c) {}
 
-    friend std::ostream& operator<<(std::ostream& os, const print_var_names& mp)
+    friend std::ostream& operator<<(std::ostream& os, const bb_names_printer& mp)
     {
-        for (int i = 0; i < var_names.size(); ++i)
-            if (mp.c_[i]) os << var_names[i] << " ";
+        for (auto i : mp.c_)
+            os << bb_names[i] << " ";
         return os;
     }
 };
 
-class print_bb_names
+template<typename Set>
+bb_names_printer<Set> print_bb_names(const Set& c)
+{
+    return bb_names_printer<Set>(c);
+}
+
+//text of operand slot k, variables by their current (renamed) id
+strview operand(const ins& i, int k)
+{
+    if (i.kind[k] == IMM_OPND)
+        return i.imm[k];
+    return var_names[k == 0 ? i.l_id : k == 1 ? i.r_id1 : i.r_id2];
+}
+
+//instruction in SSA form, without the line end
+class ssa_ins_printer
+{
+
+private:
+    const ins& i_;
+
+public:
+    ssa_ins_printer(const ins& i) : i_(i) {}
+
+    friend std::ostream& operator<<(std::ostream& os, const ssa_ins_printer& mp)
+    {
+        const ins& i = mp.i_;
+        switch (i.type) {
+            case EXIT_JUMP:
+                return os << i.opcode << " " << operand(i, 1) << " " << i.ins_label;
+            case IF:
+                if (i.kind[1] == NO_OPND)
+                    break;
+                return os << i.opcode << " " << operand(i, 1) << " " << i.oper << " " << operand(i, 2) << " " << i.ins_label;
+            case OP:
+                if (i.array == ARRAY_LEFT)
+                    return os << operand(i, 0) << "[" << operand(i, 1) << "] " << i.opcode << " " << operand(i, 2) << " " << i.ins_label;
+                if (i.array == ARRAY_RIGHT)
+                    return os << operand(i, 0) << " " << i.opcode << " " << operand(i, 1) << "[" << operand(i, 2) << "] " << i.ins_label;
+                if (i.kind[2] == NO_OPND) //unary
+                    return os << operand(i, 0) << " " << i.opcode << " " << operand(i, 1) << " " << i.ins_label;
+                //binary
+                return os << operand(i, 0) << " " << i.opcode << " " << i.oper << " " << operand(i, 1) << " " << operand(i, 2) << " " << i.ins_label;
+            default:
+                break;
+        }
+        return os << i.str;
+    }
+};
+
+ssa_ins_printer print_ssa_ins(const ins& i)
+{
+    return ssa_ins_printer(i);
+}
+
+//instruction for the TeX document, without the line ends
+class tex_ins_printer
 {
 
 private:
-    bitvector c_;
+    const ins& i_;
 
 public:
-    print_bb_names(bitvector c) : c_(c) {}
+    tex_ins_printer(const ins& i) : i_(i) {}
 
-    friend std::ostream& operator<<(std::ostream& os, const print_bb_names& mp)
+    friend std::ostream& operator<<(std::ostream& os, const tex_ins_printer& mp)
     {
-        for (int i = 0; i < bb_names.size(); ++i)
-            if (mp.c_[i]) os << bb_names[i] << " ";
-        return os;
+        const ins& i = mp.i_;
+        switch (i.type) {
+            case LABEL:
+                return os << "\\textbf{" << i.opcode << ":" << "\\hfill{" << i.ins_label << "}}";
+            case EXIT_JUMP:
+                return os << i.opcode << " \\(" << operand(i, 1) << "\\hfill{" << i.ins_label << "}\\)";
+            case IF:
+                if (i.kind[1] == NO_OPND)
+                    break;
+                return os << i.opcode << " \\(" << operand(i, 1) << " " << i.oper << " " << operand(i, 2) << " "
+                          << "\\hfill{" << i.ins_label << "}\\)";
+            case OP:
+                if (i.array == ARRAY_LEFT)
+                    return os << "\\(" << operand(i, 0) << "[" << operand(i, 1) << "] " << i.opcode << " " << operand(i, 2) << " "
+                              << "\\hfill{" << i.ins_label << "}\\)";
+                if (i.array == ARRAY_RIGHT)
+                    return os << "\\(" << operand(i, 0) << " " << i.opcode << " " << operand(i, 1) << "[" << operand(i, 2) << "] "
+                              << "\\hfill{" << i.ins_label << "}\\)";
+                if (i.kind[2] == NO_OPND) //unary
+                    return os << "\\(" << operand(i, 0) << " " << i.opcode << " " << operand(i, 1) << " "
+                              << "\\hfill{" << i.ins_label << "}\\)";
+                //binary
+                return os << "\\(" << operand(i, 0) << " " << i.opcode << " " << i.oper << ",\\ " << operand(i, 1) << ", " << operand(i, 2) << " "
+                          << "\\hfill{" << i.ins_label << "}\\)";
+            case LABEL_JUMP:
+                return os << "\\quad \\textbf{" << i.opcode << "\\ " << i.oper << "\\hfill{" << i.ins_label << "}}";
+            case ELSE:
+                return os << i.opcode << "\\hfill{" << i.ins_label << "}";
+        }
+        return os << i.str;
     }
 };
 
-vector<int> var_counter;
-vector<vector<int> > var_stack;
+tex_ins_printer print_tex_ins(const ins& i)
+{
+    return tex_ins_printer(i);
+}
+
+thread_local vector<int> var_counter;
+thread_local vector<vector<int> > var_stack;
 
 int newname(int id)
 {
     int i = var_counter[id];
     var_counter[id] += 1;
-    var_stack[id].push_back(get_index(var_names, var_names[id] + string("_") + NumberToString(i), true));
+    //version name is <name>_<i>, the same string may already be a source variable
+    string name = var_names[id];
+    name += "_";
+    name += to_string(i);
+    var_stack[id].push_back(var_names.intern(name));
     return var_stack[id].back();
 }
 
-void rename(int bb_id)
+//rename on a walk of the dominator tree: a bb's versions are pushed when it is
+//entered and popped when it is left, after its subtree
+void rename_enter(int bb_id)
 {
     for (auto &i : bbs[bb_id].phi_list)
         i.var_id = newname(i.old_id);
@@ -200,11 +366,13 @@ void rename(int bb_id)
             if (ins_list[i].l_id > -1)
                 ins_list[i].l_id = newname(ins_list[i].l_id);
         }
-    for (auto i : bbs[bb_id].succ)
+    for (auto i : flow_graph.succ(bb_id))
         for (auto &j : bbs[i].phi_list)
             j.var_ids.push_back(var_stack[j.old_id].back());
-    for (auto i : bbs[bb_id].succdom)
-        rename(i);
+}
+
+void rename_leave(int bb_id)
+{
     for (auto i : bbs[bb_id].phi_list)
         var_stack[i.old_id].pop_back();
     if (bb_id != ENTRY_ID && bb_id != EXIT_ID)
@@ -213,623 +381,733 @@ void rename(int bb_id)
                 var_stack[ins_list[i].old_l_id].pop_back();
 }
 
-int main(int argc, char* argv[])
+void rename(int bb_id)
 {
-    //parse args
-    int use_dfst = 0, all = 0, print_ir = 0,
-        print_graph = 0, print_sets = 0, print_serialize = 0,
-        print_rd = 0, print_lv = 0, print_io = 0,
-        print_dce = 0, print_dc = 0, print_nl = 0,
+    tree_walk(bb_id, [](int b){ return dom_tree.children(b); }, rename_enter, rename_leave);
+}
 
-        print_id = 1, print_df = 1, /*some other flags*/ print_ssa = 1;
+//args
+thread_local int use_dfst = 0, use_sparse = 0, use_pruned = 0, all = 0, print_ir = 0,
+    print_graph = 0, print_sets = 0, print_serialize = 0,
+    print_rd = 0, print_lv = 0, print_io = 0,
+    print_dce = 0, print_dc = 0, print_nl = 0, print_tex = 0, print_json = 0,
+    print_stats = 0, print_time_passes = 0,
 
-    char *input = NULL, *output = NULL;
-    for (;;) {
-        static struct option longopts[] =
-        {
-            { "help", no_argument, 0, 'h' },
-            { "usage", no_argument, 0, 'u' },
-            { "dfst", no_argument, &use_dfst, 1 },
-            { "ALL", no_argument, &all, 1 },
-            { "IR", no_argument, &print_ir, 1 },
-            { "G", no_argument, &print_graph, 1 },
-            { "sets", no_argument, &print_sets, 1 },
-            { "serialize", no_argument, &print_serialize, 1 },
-            { "RD", no_argument, &print_rd, 1 },
-            { "LV", no_argument, &print_lv, 1 },
-            { "IO", no_argument, &print_io, 1 },
-            { "dce", no_argument, &print_dce, 1 },
-            { "DC", no_argument, &print_dc, 1 },
-            { "NL", no_argument, &print_nl, 1 },
-            { 0,0,0,0 }
-        };
-        int optidx = 0;
-        int c = getopt_long_only(argc, argv, "hui:o:", longopts, &optidx);
-        if (c == -1)
-            break;
-#define all_coms " [-i INPUTFILE] [-o OUTPUTFILE] [-h] \\
-[-help] [-u] [-usage] [-dfst] [-ALL] [-IR] [-G] [-sets] \\
-[-serialize] [-RD] [-LV] [-IO] [-dce] [-DC] [-NL]"
-        switch (c) {
-            case 0:
-                break;
-            case 'h':
-                cerr << "Usage: " << argv[0] << all_coms << "\n"
-                << "Options:\n"
-                << "\t-h,-help\t\tShow this help list\n"
-                << "\t-u,-usage\t\tShow a short usage message\n"
-                << "\t-i <INPUTFILE>\t\tRead from INPUTFILE\n"
-                << "\t-o <OUTPUTFILE>\t\tWrite to OUTPUTFILE\n"
-                << "\t-dfst\t\t\tUse DFST algorithm for BBs numeration\n"
-                << "\t-ALL\t\t\tPrint all (union of all the following flags)\n"
-                << "\t-IR\t\t\tPrint IR with BB labels\n"
-                << "\t-G\t\t\tPrint digraph for graphviz dot\n"
-                << "\t-sets\t\t\tPrint gen, kill, use, def sets for all BBs\n"
-                << "\t-serialize\t\tPrint serialized info about BBs\n"
-                << "\t-RD\t\t\tPrint reaching definitions analysis\n"
-                << "\t-LV\t\t\tPrint live variable analysis\n"
-                << "\t-IO\t\t\tPrint Input Output sets for all BBs\n"
-                << "\t-dce\t\t\tPrint IR dead code and IR without dead code\n"
-                << "\t-DC\t\t\tPrint dominator sets for all BBs\n"
-                << "\t-NL\t\t\tPrint natural loops"
-                << endl;
-                return 0;
-            case 'u':
-                cerr << "Usage: " << argv[0] << all_coms << endl;
-                return 0;
-            case 'i':
-                if (input)
-                    cerr << "Warning: set new input file '" << optarg << "'" << endl;
-                input = optarg;
-                break;
-            case 'o':
-                if (output)
-                    cerr << "Warning: set new output file '" << optarg << "'" << endl;
-                output = optarg;
-                break;
-            case '?':
-                cerr << "Try '" << argv[0] << " -help' or '" << argv[0] << " -usage' for more information" << endl;
-                return 1;
-            default:
-                return 1;
-        }
+    print_id = 1, print_df = 1, /*some other flags*/ print_ssa = 1;
+thread_local int num_threads = 1;
+
+//workers for -j N, NULL when running on one thread
+thread_local thread_pool *pool = NULL;
+
+//per-block sets of one dataflow problem, for live variables gen is use and kill is def
+template<typename Set>
+struct dataflow_sets
+{
+    set_table<Set> gen, kill, in, out;
+
+    dataflow_sets(int n, int size) : gen(n, size), kill(n, size), in(n, size), out(n, size) {}
+};
+
+//gen/kill problem with union meet: out = gen | (in - kill) for forward problems,
+//in = gen | (out - kill) for backward ones
+template<typename Set>
+struct genkill_problem
+{
+    dataflow_sets<Set>& s;
+    flow_direction dir;
+
+    genkill_problem(dataflow_sets<Set>& a, flow_direction b) : s(a), dir(b) {}
+
+    void init(int b) { (dir == FORWARD ? s.in : s.out)[b].fill(false); }
+
+    void meet(int b, int j) { (dir == FORWARD ? s.in : s.out)[b] |= (dir == FORWARD ? s.out : s.in)[j]; }
+
+    bool transfer(int b)
+    {
+        if (dir == FORWARD)
+            return s.out[b].assign_transfer(s.gen[b], s.in[b], s.kill[b]);
+        return s.in[b].assign_transfer(s.gen[b], s.out[b], s.kill[b]);
     }
-    if (!(all || print_ir || print_graph || print_sets || print_serialize || print_rd || print_lv || print_io || print_dce || print_dc || print_nl)) {
-        cerr << "Error: No any requests (output opts)\nTry '" << argv[0] << " -help' or '" << argv[0] << " -usage' for more information" << endl;
-        return 1;
+
+    //facts that may no longer hold after the gen and kill sets of some blocks changed,
+    //every other fact can only be added, so reset only takes these away
+    Set lost;
+    //results put aside by reset
+    map<int, Set> saved;
+
+    bool grow_only() const { return lost.find_first() == -1; }
+
+    void reset(int b)
+    {
+        auto &&r = (dir == FORWARD ? s.out : s.in)[b];
+        saved[b] = Set(r);
+        r -= lost;
     }
-    
-//DEBUG
-all = 0;   
-print_id = 0, print_df = 0, print_ssa = 0; 
-    
-    if (all)
-        print_ir = print_graph = print_sets = print_serialize = print_rd = print_lv = print_io = print_dce = print_dc = print_nl = 1;
 
-    //redirect streams
-    ifstream in;
-    ofstream out;
-    if (input) {
-        in.open(input);
-        cin.rdbuf(in.rdbuf());
+    bool changed(int b) { return !(saved[b] == (dir == FORWARD ? s.out : s.in)[b]); }
+};
+
+//sequential worklist solver, or the parallel one with -j N
+template<typename Problem>
+solver_stats solve(flow_direction dir, int boundary, Problem& pb)
+{
+    if (pool)
+        return solve_parallel(flow_graph, ENTRY_ID, dir, boundary, pb, *pool);
+    return solve_worklist(flow_graph, ENTRY_ID, dir, boundary, pb);
+}
+
+//dominators: intersection meet, dom = {b} | meet of the preds
+template<typename Set>
+struct dom_problem
+{
+    set_table<Set>& dom;
+    Set tmp;
+
+    dom_problem(set_table<Set>& a, int p) : dom(a), tmp(p) {}
+
+    void init(int b) { tmp.fill(true); }
+
+    void meet(int b, int j) { tmp &= dom[j]; }
+
+    bool transfer(int b)
+    {
+        tmp[b] = true;
+        if (tmp == dom[b])
+            return false;
+        dom[b] = tmp;
+        return true;
     }
-    if (output) {
-        out.open(output);
-        cout.rdbuf(out.rdbuf());
+};
+
+//number every definition and list the definitions of each variable
+void number_definitions()
+{
+    var_defs.assign(var_names.size(), vector<int>());
+    for (auto &i : ins_list) {
+        i.def_id = -1;
+        if (i.l_id < 0)
+            continue;
+        i.def_id = all_def.size();
+        all_def.push_back(make_tuple(i.ins_id, i.l_id));
+        var_defs[i.l_id].push_back(i.def_id);
     }
+}
 
-    //add entry and exit bbs
-    ENTRY_ID = get_index(bb_names, string("entry"), true);
-    EXIT_ID = get_index(bb_names, string("exit"), true);
-    bbs.resize(2);
-    bbs[0].name_id = ENTRY_ID;
-    bbs[1].name_id = EXIT_ID;
+//entry_live: variables live out of entry, they get version 0 before renaming,
+//var_live_in: for -pruned the blocks each variable is live into in increasing order
+thread_local vector<int> entry_live;
+thread_local vector<vector<int> > var_live_in;
 
-    //ins input
-    map<int, int> labels_to_ins_id;
-    bool errfl = false;
-    int cur_ins;
-    for (string line; getline(cin, line);) {
-        cur_ins = ins_list.size();
-        istringstream iss(line);
-        vector<string> tokens{istream_iterator<string>{iss}, istream_iterator<string>{}};
-        string k1, k2;
-        switch (tokens.size()) {
-            case 0:
-                //empty
-                break;
-            case 2:
-                //else, label or ifTrue without parameters
-                if (tokens[0].compare("else") == 0) {
-                    //ins[cur_ins - 2] must exist and have IF type
-                    if (cur_ins - 2 < 0 || ins_list[cur_ins - 2].type != IF) {
-                        cerr << "Error: unexpected command 'else' in a line '" << line << "'" << endl;
-                        return 1;
-                    }
-                    ins_list.push_back({cur_ins, line, tokens[1], ELSE, -1, -1, -1, -1});
-                } else if (tokens[0].compare("ifTrue") == 0)
-                    ins_list.push_back({cur_ins, line, tokens[1], IF, -1, -1, -1, -1});
-                else {
-                    int tmp;
-                    ins_list.push_back({cur_ins, line, tokens[1], LABEL, tmp = get_index(labels_names, tokens[0], true), -1, -1, -1});
-                    labels_to_ins_id[tmp] = cur_ins;
-                }
-                break;
-            case 3:
-                //goto, return
-                if (tokens[0].compare("goto") == 0)
-                    ins_list.push_back({cur_ins, line, tokens[2], LABEL_JUMP, get_index(labels_names, tokens[1], true), -1, -1 , -1});
-                else
-                    ins_list.push_back({cur_ins, line, tokens[2], EXIT_JUMP, -1, -1,
-                                        is_number(tokens[1]) ? -1 : get_index(var_names, tokens[1], true), -1});
-                break;
-            case 4:
-                //unary operation
-                if (is_array_element(tokens[0], k1, k2)) //in left part array element k1[k2]
-                    ins_list.push_back({cur_ins, line, tokens[3], OP, -1,
-                                        is_number(k1) ? -1 : get_index(var_names, k1, true),
-                                        is_number(k2) ? -1 : get_index(var_names, k2, true),
-                                        is_number(tokens[2]) ? -1 : get_index(var_names, tokens[2], true)});
-                else if (is_array_element(tokens[2], k1, k2)) //in right part array element k1[k2]
-                    ins_list.push_back({cur_ins, line, tokens[3], OP, -1,
-                                        is_number(tokens[0]) ? -1 : get_index(var_names, tokens[0], true),
-                                        is_number(k1) ? -1 : get_index(var_names, k1, true),
-                                        is_number(k2) ? -1 : get_index(var_names, k2, true)});
-                else
-                    ins_list.push_back({cur_ins, line, tokens[3], OP, -1,
-                                        is_number(tokens[0]) ? -1 : get_index(var_names, tokens[0], true),
-                                        is_number(tokens[2]) ? -1 : get_index(var_names, tokens[2], true),
-                                        -1});
-                break;
-            case 5:
-                //ifTrue with 2 variables in condition
-                ins_list.push_back({cur_ins, line, tokens[4], IF, -1, -1,
-                                    is_number(tokens[1]) ? -1 : get_index(var_names, tokens[1], true),
-                                    is_number(tokens[3]) ? -1 : get_index(var_names, tokens[3], true)});
-                break;
-            case 6:
-                //binary operation
-                ins_list.push_back({cur_ins, line, tokens[5], OP, -1,
-                                    is_number(tokens[0]) ? -1 : get_index(var_names, tokens[0], true),
-                                    is_number(tokens[3]) ? -1 : get_index(var_names, tokens[3], true),
-                                    is_number(tokens[4]) ? -1 : get_index(var_names, tokens[4], true)});
-                break;
-            default:
-                //some error
-                cerr << tokens.size() << ":'" << line << "'" << endl;
-                errfl = true;
+//sections of a cache entry, one per cached pass
+enum cache_section
+{
+    CACHE_PARSE,
+    CACHE_CFG,
+    CACHE_GEN_KILL,
+    CACHE_USE_DEF,
+    CACHE_RD,
+    CACHE_LV,
+    CACHE_DOM
+};
+
+enum var_set_kind
+{
+    USE_SET,
+    DEF_SET,
+    LIVE_IN_SET,
+    LIVE_OUT_SET
+};
+
+//gen kill use def sets, RD and LV analysis, Input Output sets and dead code,
+//every step is a pass or an output of main
+class dataflow_analysis
+{
+
+public:
+    virtual ~dataflow_analysis() {}
+
+    //rd gen and kill sets
+    virtual void gen_kill() = 0;
+
+    //lv use and def sets, gen and kill of the lv problem
+    virtual void use_def() = 0;
+
+    //a trace gets the sets after every sweep (-RD)
+    virtual void reaching_definitions(ostream *trace) = 0;
+
+    //also sets entry_live and var_live_in, a trace gets the sets after every sweep (-LV)
+    virtual void live_variables(ostream *trace) = 0;
+
+    //after instructions of blocks were replaced in place, with the CFG unchanged:
+    //gen/kill and use/def of the blocks are computed again, and RD and LV solved
+    //again from their current fixpoint. An edit that adds a variable, or adds or
+    //removes a definition, renumbers the sets and everything is computed again
+    virtual void update(const vector<int>& blocks) = 0;
+
+    //variables of one lv set of b in increasing order
+    virtual void vars(var_set_kind k, int b, vector<int>& out) = 0;
+
+    virtual void print_sets(ostream& os) = 0;
+
+    virtual void print_io(ostream& os) = 0;
+
+    virtual void print_dead_code(ostream& os) = 0;
+
+    //the sets of the gen/kill, use/def, rd or lv pass
+    virtual void save(cache_section s, cache_writer& w) = 0;
+
+    //instead of running the pass, r must be at section s,
+    //the sets of gen/kill and use/def are allocated by their load
+    virtual void load(cache_section s, cache_reader& r) = 0;
+};
+
+thread_local unique_ptr<dataflow_analysis> dataflow;
+
+//RDSet and LVSet are bitvector or hybridset, the sets of a problem are
+//allocated by the pass that fills them
+template<typename RDSet, typename LVSet>
+class dataflow_analyses : public dataflow_analysis
+{
+
+private:
+    unique_ptr<dataflow_sets<RDSet> > rd_;
+    unique_ptr<dataflow_sets<LVSet> > lv_;
+
+    //entry_live and var_live_in from the lv sets
+    void collect_live()
+    {
+        dataflow_sets<LVSet> &lv = *lv_;
+        int t = var_names.size();
+        entry_live.clear();
+        for (auto i : lv.out[ENTRY_ID])
+            entry_live.push_back(i);
+        if (use_pruned) {
+            var_live_in.assign(t, vector<int>());
+            for (auto &i : bbs)
+                for (auto v : lv.in[i.name_id])
+                    var_live_in[v].push_back(i.name_id);
         }
     }
-    if (errfl)
-        return 1;
-    if (ins_list.size() == 0) {
-        cerr << "Error: empty intermediate representation" << endl;
-        return 1;
+
+    //sparse sets are saved as the members of every block's set, the end of
+    //each block's run and the runs, dense ones as the words of every block's row.
+    //Either form loads into either set type, so -sparse can differ between runs
+    enum table_form
+    {
+        SET_LISTS,
+        SET_WORDS
+    };
+
+    template<typename Set>
+    static void put_table(cache_writer& w, const set_table<Set>& t)
+    {
+        vector<uint32_t> ends, items;
+        for (size_t b = 0; b < bbs.size(); ++b) {
+            for (auto i : t[b])
+                items.push_back(i);
+            ends.push_back(items.size());
+        }
+        w.put((uint64_t)SET_LISTS);
+        w.put(ends);
+        w.put(items);
     }
 
-    //partition into bbs
-    vector<int> leaders;
-    bool next_leader = true;
-    for (auto i : ins_list) {
-        switch (i.type) {
-            case OP:
-            case IF:
-            case LABEL:
-                if (next_leader)
-                    get_index(leaders, i.ins_id, true);
-            case ELSE:
-                next_leader = false;
-                break;
-            case EXIT_JUMP:
-                if (next_leader)
-                    get_index(leaders, i.ins_id, true);
-                next_leader = true;
-                break;
-            case LABEL_JUMP:
-                if (next_leader)
-                    get_index(leaders, i.ins_id, true);
-                else
-                    get_index(leaders, labels_to_ins_id[i.id], true);
-                next_leader = true;
-        }
+    static void put_table(cache_writer& w, const set_table<bitvector>& t)
+    {
+        size_t n = t[0].words();
+        w.put((uint64_t)SET_WORDS);
+        w.put((uint64_t)n);
+        for (size_t b = 0; b < bbs.size(); ++b)
+            w.put_bytes(t[b].data(), n * sizeof(bitvector::word));
     }
-    assert(leaders.size() != 0);
-    sort(leaders.begin(), leaders.end());
-    for (int i = 0; i < leaders.size() - 1; ++i)
-        bbs.push_back({i + 2, leaders[i], leaders[i + 1] - 1});
-    bbs.push_back({leaders.size() + 1, leaders[leaders.size() - 1], ins_list.size() - 1});
-    bbs[ENTRY_ID].succ.push_back(2);//First real bb
-    bbs[2].pred.push_back(ENTRY_ID);
-    for (auto &i : bbs) {
-        if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
-            continue;
-        bool fall_through = false;
-        int check_insns[2], check_count = 0;
-        //if (goto|return)
-        if (i.last_ins - 1 >= i.first_ins && ins_list[i.last_ins - 1].type == IF) {
-            check_insns[check_count++] = i.last_ins;
-            fall_through = true;
-        //if (goto|return) else (goto|return)
-        } else if (i.last_ins - 2 >= i.first_ins && ins_list[i.last_ins - 1].type == ELSE) {
-            check_insns[check_count++] = i.last_ins;
-            check_insns[check_count++] = i.last_ins - 2;
-        //(goto|return)
-        } else if (ins_list[i.last_ins].type == EXIT_JUMP || ins_list[i.last_ins].type == LABEL_JUMP)
-            check_insns[check_count++] = i.last_ins;
-        //other
-        else
-            fall_through = true;
-        for (int j = 0; j < check_count; ++j) {
-            if (ins_list[check_insns[j]].type == LABEL_JUMP) {
-                auto k = lower_bound(leaders.begin(), leaders.end(), labels_to_ins_id[ins_list[check_insns[j]].id]) - leaders.begin();
-                i.succ.push_back(k + 2);
-                bbs[k + 2].pred.push_back(i.name_id);
-            } else if (ins_list[check_insns[j]].type == EXIT_JUMP) {
-                i.succ.push_back(EXIT_ID);
-                bbs[EXIT_ID].pred.push_back(i.name_id);
+
+    static void copy_row(bitrow s, const vector<bitvector::word>& row)
+    {
+        copy(row.begin(), row.end(), s.data());
+    }
+
+    template<typename Set>
+    static void copy_row(Set& s, const vector<bitvector::word>& row)
+    {
+        for (auto it = bitvector::const_iterator(row.data(), row.data() + row.size()),
+                end = bitvector::const_iterator(row.data() + row.size(), row.data() + row.size()); it != end; ++it)
+            s[*it] = true;
+    }
+
+    //the sets of a table saved in either form, size is the size of every set
+    template<typename Table>
+    static void get_table(cache_reader& r, Table& t, size_t size)
+    {
+        if (r.get<uint64_t>() == SET_WORDS) {
+            vector<bitvector::word> row(r.get<uint64_t>());
+            if (row.size() != (size + bitvector::word_bits - 1) / bitvector::word_bits)
+                return;
+            for (size_t b = 0; b < bbs.size(); ++b) {
+                r.get_bytes(row.data(), row.size() * sizeof(bitvector::word));
+                copy_row(t[b], row);
             }
+            return;
         }
-        if (fall_through) {
-            int tmp = i.name_id == bbs.size() - 1 ? EXIT_ID : i.name_id + 1;
-            i.succ.push_back(tmp);
-            bbs[tmp].pred.push_back(i.name_id);
-        }
+        vector<uint32_t> ends, items;
+        r.get(ends);
+        r.get(items);
+        size_t k = 0;
+        for (size_t b = 0; b < ends.size() && b < bbs.size(); ++b)
+            for (; k < ends[b] && k < items.size(); ++k)
+                if (items[k] < size)
+                    t[b][items[k]] = true;
     }
 
-    //set BB labels
-    if (use_dfst) {
-        bb_names.resize(bbs.size());
-        vector<bool> visited;
-        visited.assign(bbs.size(), false);
-        visited[ENTRY_ID] = visited[EXIT_ID] = true;
-        DFST(visited, bbs[ENTRY_ID].succ);
-    } else
-        for (int i = 2; i < bbs.size(); ++i)
-            bb_names.push_back(string("BB") + NumberToString(i - 1));
+    //masks of all definitions of a variable, only for variables whose definitions
+    //outnumber the words of a mask, the others set their kill bits one by one
+    struct def_masks
+    {
+        vector<int> id;
+        set_table<RDSet> masks;
 
-    //set bb_id and old_l_id for each ins
-    for (int i = 2; i < bbs.size(); ++i)
-        for (int j = bbs[i].first_ins; j <= bbs[i].last_ins; ++j) {
-            ins_list[j].bb_id = bbs[i].name_id;
-            ins_list[j].old_l_id = ins_list[j].l_id;
+        static int number(const vector<int>& vars, vector<int>& id)
+        {
+            int n = 0;
+            for (auto v : vars)
+                if (id[v] == -1 && var_defs[v].size() * bitvector::word_bits >= all_def.size())
+                    id[v] = n++;
+            return n;
         }
 
-    //print IR with BB labels
-    if (print_ir)
-        for (auto i : bbs) {
-            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
-                continue;
-            cout << bb_names[i.name_id] << endl;
-            for (int j = i.first_ins; j <= i.last_ins; ++j)
-                cout << ins_list[j].str << endl;
-            cout << endl;
+        //masks of the variables in vars
+        def_masks(const vector<int>& vars) : id(var_names.size(), -1), masks(number(vars, id), all_def.size())
+        {
+            for (auto v : vars)
+                if (id[v] >= 0)
+                    for (auto d : var_defs[v])
+                        masks[id[v]][d] = true;
         }
 
-    //print digraph for graphviz dot
-    if (print_graph) {
-        cout << "digraph G {" << endl;
-        for (auto &i : bbs)
-            for (auto &j : i.succ)
-                cout << "	" << bb_names[i.name_id] << " -> " << bb_names[j] << ";" << endl;
-        cout << "}" << endl << endl;
-    }
-
-    //calculate all definitions vector
-    map<int, vector<int> > var_to_ins;
-    for (auto i : ins_list) {
-        if (i.l_id < 0)
-            continue;
-        get_index(all_def, make_tuple(i.ins_id, i.l_id), true);
-        var_to_ins[i.l_id].push_back(i.ins_id);
-    }
+        template<typename Row>
+        void kill_all(Row& kill, int v)
+        {
+            if (id[v] >= 0)
+                kill |= masks[id[v]];
+            else
+                for (auto d : var_defs[v])
+                    kill[d] = true;
+        }
+    };
 
-    //calculate gen kill use def sets
-    int c = all_def.size();
-    int t = var_names.size();
-    for (auto &i : bbs) {
-        i.gen = i.kill = i.in_rd = i.out_rd = bitvector(c);
-        i.use = i.def = i.in_lv = i.out_lv = bitvector(t);
-        if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
-            continue;//sets must be init
-         //calculate gen kill
+    //gen and kill of block i into empty sets. seen_bb is the block that last defined
+    //a variable and only_def its definition there, -1 if there are several
+    void block_gen_kill(const bb& i, def_masks& m, vector<int>& seen_bb, vector<int>& only_def)
+    {
+        dataflow_sets<RDSet> &rd = *rd_;
+        auto &&gen = rd.gen[i.name_id], &&kill = rd.kill[i.name_id];
+        vector<int> block_vars;
         for (auto j = i.last_ins; j >= i.first_ins; --j) {
-            if (ins_list[j].l_id < 0) //skip operations without left part
+            int v = ins_list[j].l_id;
+            if (v < 0) //skip operations without left part
+                continue;
+            if (seen_bb[v] == i.name_id) {
+                only_def[v] = -1;
                 continue;
-            bitvector tmp_gen(c);
-            tmp_gen[get_index(all_def, make_tuple(ins_list[j].ins_id, ins_list[j].l_id), false)] = true;
-            i.gen = i.gen + (tmp_gen - i.kill);
-            for (auto k : var_to_ins[ins_list[j].l_id]) {
-                if (k == ins_list[j].ins_id)
-                        continue;
-                i.kill[get_index(all_def, make_tuple(k, ins_list[j].l_id), false)] = true;
             }
+            //the last definition of v in the block is generated and kills all others
+            seen_bb[v] = i.name_id;
+            only_def[v] = ins_list[j].def_id;
+            gen[ins_list[j].def_id] = true;
+            m.kill_all(kill, v);
+            block_vars.push_back(v);
         }
-        //calculate use def
+        //several definitions of v in the block kill each other, a single one survives
+        for (auto v : block_vars)
+            if (only_def[v] >= 0)
+                kill[only_def[v]] = false;
+    }
+
+    //use and def of block i into empty sets
+    void block_use_def(const bb& i)
+    {
+        dataflow_sets<LVSet> &lv = *lv_;
+        auto &&use = lv.gen[i.name_id], &&def = lv.kill[i.name_id];
         for (auto j = i.first_ins; j <= i.last_ins; ++j) {
-            if (ins_list[j].r_id1 > -1 && i.def[ins_list[j].r_id1] == false)
-                i.use[ins_list[j].r_id1] = true;
-            if (ins_list[j].r_id2 > -1 && i.def[ins_list[j].r_id2] == false)
-                i.use[ins_list[j].r_id2] = true;
+            if (ins_list[j].r_id1 > -1 && def[ins_list[j].r_id1] == false)
+                use[ins_list[j].r_id1] = true;
+            if (ins_list[j].r_id2 > -1 && def[ins_list[j].r_id2] == false)
+                use[ins_list[j].r_id2] = true;
             if (ins_list[j].l_id > -1)
-                i.def[ins_list[j].l_id] = true;
+                def[ins_list[j].l_id] = true;
         }
-        if (print_sets == 0)
-            continue;
-        cout << bb_names[i.name_id] << ":" << endl;
-        cout << "Gen   : " << print_var_bb_names(i.gen) << endl;
-        cout << "Kill  : " << print_var_bb_names(i.kill) << endl;
-        cout << "Use   : " << print_var_names(i.use) << endl;
-        cout << "Def   : " << print_var_names(i.def) << endl << endl;
-    }
-
-    //print information about all bbs
-    if (print_serialize) {
-        cout << "baseBlocks = [" << endl;
-        bool o_tmp1 = false, o_tmp2 = false;
-        for (auto i : bbs) {
-            if (o_tmp1)
-                cout << "," << endl;
-            else
-                o_tmp1 = true;
-            cout << "    {" << endl;
-            cout << "        'letter' : '" << bb_names[i.name_id] << "'," << endl;
-            cout << "        'pred' : [";
-            o_tmp2 = false;
-            for (auto j : i.pred) {
-                if (o_tmp2)
-                    cout << ", ";
-                else
-                    o_tmp2 = true;
-                cout << j;
-            }
-            cout << "]," << endl;
-            cout << "        'succ' : [";
-            o_tmp2 = false;
-            for (auto j : i.succ) {
-                if (o_tmp2)
-                    cout << ", ";
-                else
-                    o_tmp2 = true;
-                cout << j;
-            }
-            cout << "]," << endl;
-            cout << "        'assign' : [";
-            o_tmp2 = false;
-            for (int j = 0; j < var_names.size(); ++j) {
-                if (i.def[j] == false)
-                    continue;
-                if (o_tmp2)
-                    cout << ", ";
-                else
-                    o_tmp2 = true;
-                cout << "'" << var_names[j] << "'";
-            }
-            cout << "]," << endl;
-            cout << "        'access' : [";
-                    o_tmp2 = false;
-            for (int j = 0; j < var_names.size(); ++j) {
-                if (i.use[j] == false)
-                    continue;
-                if (o_tmp2)
-                    cout << ", ";
-                else
-                    o_tmp2 = true;
-                cout << "'" << var_names[j] << "'";
-            }
-            cout << "]" << endl;
-            cout << "    }";
+    }
+
+    //the sets of blocks computed again, the facts gen lost or kill gained go to lost,
+    //only results holding them can shrink
+    template<typename Set, typename Compute>
+    static void recompute(dataflow_sets<Set>& s, const vector<int>& blocks, Set& lost, Compute compute)
+    {
+        for (auto b : blocks) {
+            Set gen(s.gen[b]), kill(s.kill[b]);
+            s.gen[b].fill(false);
+            s.kill[b].fill(false);
+            compute(b);
+            gen -= s.gen[b];
+            lost |= gen;
+            Set gained(s.kill[b]);
+            gained -= kill;
+            lost |= gained;
         }
-        cout << endl<< "]" << endl << endl;
     }
 
-    //rd analysis
-    bool change = true;
-    int iter_num = 0;
-    if (print_rd)
-        cout << "RD analysis:" << endl;
-    while (change) {
-        change = false;
+public:
+    void gen_kill()
+    {
+        int c = all_def.size();
+        int t = var_names.size();
+        rd_.reset(new dataflow_sets<RDSet>(bbs.size(), c));
+        vector<int> vars(t);
+        for (int v = 0; v < t; ++v)
+            vars[v] = v;
+        def_masks masks(vars);
+        vector<int> seen_bb(t, -1), only_def(t);
         for (auto &i : bbs) {
-            if (i.name_id == ENTRY_ID)
-                continue;
-            i.in_rd = bitvector(c);
-            for (auto j : i.pred)
-                i.in_rd = i.in_rd + bbs[j].out_rd;
-            bitvector out_new = i.gen + (i.in_rd - i.kill);
-            if (!(out_new == i.out_rd)) {
-                i.out_rd = out_new;
-                change = true;
-            }
+            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
+                continue;//sets must be init
+            block_gen_kill(i, masks, seen_bb, only_def);
         }
-        if (print_rd == 0)
-            continue;
-        cout << endl << "Iter num: " << ++iter_num << endl;
+    }
+
+    void use_def()
+    {
+        lv_.reset(new dataflow_sets<LVSet>(bbs.size(), var_names.size()));
         for (auto &i : bbs) {
-            cout << bb_names[i.name_id] << ":" << endl;
-            cout << "In_rd : " << print_var_bb_names(i.in_rd) << endl;
-            cout << "Out_rd: " << print_var_bb_names(i.out_rd) << endl;
+            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
+                continue;//sets must be init
+            block_use_def(i);
         }
     }
-    if (print_rd)
-        cout << endl;
 
-    //lv analysis
-    change = true;
-    iter_num = 0;
-    if (print_lv)
-        cout << "LV analysis:" << endl;
-    while (change) {
-        change = false;
-        for (auto &i : bbs) {
-            if (i.name_id == EXIT_ID)
+    void reaching_definitions(ostream *trace)
+    {
+        dataflow_sets<RDSet> &rd = *rd_;
+        solver_stats stats;
+        genkill_problem<RDSet> rd_pb(rd, FORWARD);
+        if (trace) {
+            ostream &os = *trace;
+            os << "RD analysis:\n";
+            stats = solve_round_robin(flow_graph, FORWARD, ENTRY_ID, rd_pb, [&](int iter_num){
+                os << "\nIter num: " << iter_num << '\n';
+                for (auto &i : bbs) {
+                    os << bb_names[i.name_id] << ":\n";
+                    os << "In_rd : " << print_var_bb_names(rd.in[i.name_id]) << '\n';
+                    os << "Out_rd: " << print_var_bb_names(rd.out[i.name_id]) << '\n';
+                }
+            });
+            os << '\n';
+        } else
+            stats = solve(FORWARD, ENTRY_ID, rd_pb);
+        if (print_stats)
+            *diag << "RD: " << stats.iterations << " iterations, " << stats.visits << " visits" << endl;
+    }
+
+    void live_variables(ostream *trace)
+    {
+        dataflow_sets<LVSet> &lv = *lv_;
+        solver_stats stats;
+        genkill_problem<LVSet> lv_pb(lv, BACKWARD);
+        if (trace) {
+            ostream &os = *trace;
+            os << "LV analysis:\n";
+            stats = solve_round_robin(flow_graph, BACKWARD, EXIT_ID, lv_pb, [&](int iter_num){
+                os << "\nIter num: " << iter_num << '\n';
+                for (auto &i : bbs) {
+                    os << bb_names[i.name_id] << ":\n";
+                    os << "In_lv : " << print_var_names(lv.in[i.name_id]) << '\n';
+                    os << "Out_lv: " << print_var_names(lv.out[i.name_id]) << '\n';
+                }
+            });
+            os << '\n';
+        } else
+            stats = solve(BACKWARD, EXIT_ID, lv_pb);
+        if (print_stats)
+            *diag << "LV: " << stats.iterations << " iterations, " << stats.visits << " visits" << endl;
+        collect_live();
+    }
+
+    void save(cache_section s, cache_writer& w)
+    {
+        w.begin(s);
+        if (s == CACHE_GEN_KILL || s == CACHE_RD) {
+            put_table(w, s == CACHE_GEN_KILL ? rd_->gen : rd_->in);
+            put_table(w, s == CACHE_GEN_KILL ? rd_->kill : rd_->out);
+        } else {
+            put_table(w, s == CACHE_USE_DEF ? lv_->gen : lv_->in);
+            put_table(w, s == CACHE_USE_DEF ? lv_->kill : lv_->out);
+        }
+    }
+
+    void load(cache_section s, cache_reader& r)
+    {
+        int c = all_def.size(), t = var_names.size();
+        if (s == CACHE_GEN_KILL)
+            rd_.reset(new dataflow_sets<RDSet>(bbs.size(), c));
+        if (s == CACHE_USE_DEF)
+            lv_.reset(new dataflow_sets<LVSet>(bbs.size(), t));
+        if (s == CACHE_GEN_KILL || s == CACHE_RD) {
+            get_table(r, s == CACHE_GEN_KILL ? rd_->gen : rd_->in, c);
+            get_table(r, s == CACHE_GEN_KILL ? rd_->kill : rd_->out, c);
+        } else {
+            get_table(r, s == CACHE_USE_DEF ? lv_->gen : lv_->in, t);
+            get_table(r, s == CACHE_USE_DEF ? lv_->kill : lv_->out, t);
+        }
+        if (s == CACHE_LV)
+            collect_live();
+    }
+
+    void update(const vector<int>& blocks)
+    {
+        bool renumber = var_names.size() != var_defs.size();
+        for (auto b : blocks) {
+            if (b == ENTRY_ID || b == EXIT_ID)
+                continue;
+            for (int j = bbs[b].first_ins; j <= bbs[b].last_ins; ++j)
+                if ((ins_list[j].def_id < 0) != (ins_list[j].l_id < 0))
+                    renumber = true;
+        }
+        if (renumber) {
+            all_def.clear();
+            number_definitions();
+            gen_kill();
+            use_def();
+            reaching_definitions(NULL);
+            live_variables(NULL);
+            return;
+        }
+        //a definition moved to another variable changes the kill sets of all blocks defining either one
+        vector<int> lv_blocks, moved;
+        for (auto b : blocks) {
+            if (b == ENTRY_ID || b == EXIT_ID)
                 continue;
-            i.out_lv = bitvector(t);
-            for (auto j : i.succ)
-                i.out_lv = i.out_lv + bbs[j].in_lv;
-            bitvector in_new = i.use + (i.out_lv - i.def);
-            if (!(in_new == i.in_lv)) {
-                i.in_lv = in_new;
-                change = true;
+            lv_blocks.push_back(b);
+            for (int j = bbs[b].first_ins; j <= bbs[b].last_ins; ++j) {
+                int d = ins_list[j].def_id, v = ins_list[j].l_id;
+                if (d < 0 || get<1>(all_def[d]) == v)
+                    continue;
+                int w = get<1>(all_def[d]);
+                var_defs[w].erase(find(var_defs[w].begin(), var_defs[w].end(), d));
+                var_defs[v].insert(lower_bound(var_defs[v].begin(), var_defs[v].end(), d), d);
+                get<1>(all_def[d]) = v;
+                moved.push_back(w);
+                moved.push_back(v);
             }
         }
-        if (print_lv == 0)
-            continue;
-        cout << endl << "Iter num: " << ++iter_num << endl;
+        vector<int> rd_blocks(lv_blocks);
+        for (auto v : moved)
+            for (auto d : var_defs[v])
+                rd_blocks.push_back(ins_list[get<0>(all_def[d])].bb_id);
+        sort(rd_blocks.begin(), rd_blocks.end());
+        rd_blocks.erase(unique(rd_blocks.begin(), rd_blocks.end()), rd_blocks.end());
+        sort(lv_blocks.begin(), lv_blocks.end());
+        lv_blocks.erase(unique(lv_blocks.begin(), lv_blocks.end()), lv_blocks.end());
+
+        vector<int> vars;
+        for (auto b : rd_blocks)
+            for (int j = bbs[b].first_ins; j <= bbs[b].last_ins; ++j)
+                if (ins_list[j].l_id > -1)
+                    vars.push_back(ins_list[j].l_id);
+        sort(vars.begin(), vars.end());
+        vars.erase(unique(vars.begin(), vars.end()), vars.end());
+        def_masks masks(vars);
+        vector<int> seen_bb(var_names.size(), -1), only_def(var_names.size());
+        genkill_problem<RDSet> rd_pb(*rd_, FORWARD);
+        rd_pb.lost = RDSet(all_def.size());
+        recompute(*rd_, rd_blocks, rd_pb.lost, [&](int b){ block_gen_kill(bbs[b], masks, seen_bb, only_def); });
+        solver_stats stats = solve_incremental(flow_graph, ENTRY_ID, FORWARD, ENTRY_ID, rd_pb, rd_blocks);
+        if (print_stats)
+            *diag << "RD update: " << stats.iterations << " iterations, " << stats.visits << " visits" << endl;
+        genkill_problem<LVSet> lv_pb(*lv_, BACKWARD);
+        lv_pb.lost = LVSet(var_names.size());
+        recompute(*lv_, lv_blocks, lv_pb.lost, [&](int b){ block_use_def(bbs[b]); });
+        stats = solve_incremental(flow_graph, ENTRY_ID, BACKWARD, EXIT_ID, lv_pb, lv_blocks);
+        if (print_stats)
+            *diag << "LV update: " << stats.iterations << " iterations, " << stats.visits << " visits" << endl;
+        collect_live();
+    }
+
+    void vars(var_set_kind k, int b, vector<int>& out)
+    {
+        dataflow_sets<LVSet> &lv = *lv_;
+        set_table<LVSet> &sets = k == USE_SET ? lv.gen : k == DEF_SET ? lv.kill : k == LIVE_IN_SET ? lv.in : lv.out;
+        out.clear();
+        for (auto v : sets[b])
+            out.push_back(v);
+    }
+
+    void print_sets(ostream& os)
+    {
         for (auto &i : bbs) {
-            cout << bb_names[i.name_id] << ":" << endl;
-            cout << "In_lv : " << print_var_names(i.in_lv) << endl;
-            cout << "Out_lv: " << print_var_names(i.out_lv) << endl;
+            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
+                continue;
+            os << bb_names[i.name_id] << ":\n";
+            os << "Gen   : " << print_var_bb_names(rd_->gen[i.name_id]) << '\n';
+            os << "Kill  : " << print_var_bb_names(rd_->kill[i.name_id]) << '\n';
+            os << "Use   : " << print_var_names(lv_->gen[i.name_id]) << '\n';
+            os << "Def   : " << print_var_names(lv_->kill[i.name_id]) << "\n\n";
         }
     }
-    if (print_lv)
-        cout << endl;
 
-    //print Input Output sets
-    if (print_io)
+    void print_io(ostream& os)
+    {
+        dataflow_sets<RDSet> &rd = *rd_;
+        dataflow_sets<LVSet> &lv = *lv_;
         for (auto &i : bbs) {
-            cout << bb_names[i.name_id] << ":" << endl;
-            cout << "Input : " << print_var_bb_names(i.in_rd) << endl;
-            cout << "Output: " << print_var_names(i.out_lv) << endl << endl;
+            os << bb_names[i.name_id] << ":\n";
+            os << "Input : " << print_var_bb_names(rd.in[i.name_id]) << '\n';
+            os << "Output: " << print_var_names(lv.out[i.name_id]) << "\n\n";
         }
+    }
 
-    //simplest dead code elimination - experimental
-    bitvector use_ins = bitvector(ins_list.size());
-    for (auto i : bbs) {
-        if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
-            continue;
-        bitvector tmp = i.out_lv;
-        for (auto j = i.last_ins; j >= i.first_ins; --j) {
-            if (ins_list[j].type != OP)
-                use_ins[j] = true;
-            if (ins_list[j].l_id > -1 && tmp[ins_list[j].l_id]) {
-                use_ins[j] = true;
-                tmp[ins_list[j].l_id] = false;
+    void print_dead_code(ostream& os)
+    {
+        dataflow_sets<LVSet> &lv = *lv_;
+        //simplest dead code elimination - experimental
+        bitvector use_ins = bitvector(ins_list.size());
+        for (auto &i : bbs) {
+            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
+                continue;
+            LVSet tmp(lv.out[i.name_id]);
+            for (auto j = i.last_ins; j >= i.first_ins; --j) {
+                if (ins_list[j].type != OP)
+                    use_ins[j] = true;
+                if (ins_list[j].l_id > -1 && tmp[ins_list[j].l_id]) {
+                    use_ins[j] = true;
+                    tmp[ins_list[j].l_id] = false;
+                }
+                if (ins_list[j].r_id1 > -1 && use_ins[j])
+                    tmp[ins_list[j].r_id1] = true;
+                if (ins_list[j].r_id2 > -1 && use_ins[j])
+                    tmp[ins_list[j].r_id2] = true;
             }
-            if (ins_list[j].r_id1 > -1 && use_ins[j])
-                tmp[ins_list[j].r_id1] = true;
-            if (ins_list[j].r_id2 > -1 && use_ins[j])
-                tmp[ins_list[j].r_id2] = true;
         }
-    }
-    if (print_dce) {
-        cout << "IR dead code:" << endl;
-        for (auto i : ins_list)
+        os << "IR dead code:\n";
+        for (auto &i : ins_list)
             if (!use_ins[i.ins_id])
-                cout << i.str << endl;
-        cout << endl;
-        cout << "IR without dead code:" << endl;
-        for (auto i : ins_list)
+                os << i.str << '\n';
+        os << '\n';
+        os << "IR without dead code:\n";
+        for (auto &i : ins_list)
             if (use_ins[i.ins_id])
-                cout << i.str << endl;
-        cout << endl;
+                os << i.str << '\n';
+        os << '\n';
     }
+};
+
+//sparse sets pay off once the universe does not fit in one chunk
+unique_ptr<dataflow_analysis> make_dataflow()
+{
+    bool sparse_rd = use_sparse || all_def.size() > hybridset::chunk_bits;
+    bool sparse_lv = use_sparse || var_names.size() > hybridset::chunk_bits;
+    if (sparse_rd && sparse_lv)
+        return unique_ptr<dataflow_analysis>(new dataflow_analyses<hybridset, hybridset>());
+    if (sparse_rd)
+        return unique_ptr<dataflow_analysis>(new dataflow_analyses<hybridset, bitvector>());
+    if (sparse_lv)
+        return unique_ptr<dataflow_analysis>(new dataflow_analyses<bitvector, hybridset>());
+    return unique_ptr<dataflow_analysis>(new dataflow_analyses<bitvector, bitvector>());
+}
+
+//-NL: the loop nesting forest, every loop under its parent with the header
+//and depth, then all its blocks, latches and exit edges
+void print_loops(ostream& os)
+{
+    os << "Natural loops:\n";
+    vector<int> members;
+    for (auto r : loop_tree.roots())
+        tree_walk(r, [](int l) -> const vector<int>& { return loop_tree[l].children; },
+            [&](int l){
+                const loop &x = loop_tree[l];
+                string indent((x.depth - 1) * 4, ' ');
+                loop_tree.members(l, members);
+                os << indent << bb_names[x.header] << " (depth " << x.depth << "): " << print_bb_names(members) << '\n';
+                os << indent << "  latches: " << print_bb_names(x.latches) << '\n';
+                os << indent << "  exits: ";
+                for (auto e : x.exits)
+                    os << bb_names[e.first] << "->" << bb_names[e.second] << " ";
+                os << '\n';
+            }, no_visit());
+    if (loop_tree.size() == 0)
+        os << "None\n";
+    os << '\n';
+}
 
-    //calculate dominator sets
+//-DC: the dominator sets of the iterative algorithm after every sweep,
+//Set holds the blocks of one set
+template<typename Set>
+void trace_dominators(ostream& os)
+{
     int p = bbs.size();
-    (bbs[ENTRY_ID].dom = bitvector(p))[ENTRY_ID] = true;
-    for (auto &i : bbs) {
-        if (i.name_id == ENTRY_ID)
-            continue;
-        i.dom = bitvector(p, true);
-    }
-    change = true;
-    iter_num = 0;
-    if (print_dc)
-        cout << "Dominator computing:" << endl;
-    while (change) {
-        change = false;
-        for (auto &i : bbs) {
-            if (i.name_id == ENTRY_ID)
-                continue;
-            bitvector tmp = bitvector(p, true);
-            for (auto j : i.pred)
-                tmp = tmp * bbs[j].dom;
-            tmp[i.name_id] = true;
-            if (!(tmp == i.dom)) {
-                i.dom = tmp;
-                change = true;
-            }
-        }
-        if (print_dc == 0)
-            continue;
-        cout << endl << "Iter num: " << ++iter_num << endl;
+    set_table<Set> dom(p, p, true);
+    dom[ENTRY_ID].fill(false);
+    dom[ENTRY_ID][ENTRY_ID] = true;
+    dom_problem<Set> dom_pb(dom, p);
+    os << "Dominator computing:\n";
+    solve_round_robin(flow_graph, FORWARD, ENTRY_ID, dom_pb, [&](int iter_num){
+        os << "\nIter num: " << iter_num << '\n';
         for (auto &i : bbs)
-            cout << bb_names[i.name_id] << " dom: " << print_bb_names(i.dom) << endl;
-    }
-    if (print_dc)
-        cout << endl;
+            os << bb_names[i.name_id] << " dom: " << print_bb_names(dom[i.name_id]) << '\n';
+    });
+    os << '\n';
+}
 
-    //search natural loops
-    vector<bitvector> natural_loops;
-    for (auto &i : bbs)
-        for (auto &j : i.succ)
-            if (i.dom[j]) {
-                bitvector loop(p, false);
-                loop[j] = true;
-                loops_search(i.name_id, loop);
-                get_index(natural_loops, loop, true);
-            }
-    if (print_nl) {
-        cout << "Natural loops:" << endl;
-        for (auto i : natural_loops)
-            cout << print_bb_names(i) << endl;
-        if (natural_loops.size() == 0)
-            cout << "None" << endl;
-        cout << endl;
-    }
+//immediate dominators and the dominator tree
+void calc_dominators()
+{
+    solver_stats stats;
+    dom_tree.build(flow_graph, ENTRY_ID, &stats);
+    if (print_stats)
+        *diag << "DC: " << stats.iterations << " iterations, " << stats.visits << " visits" << endl;
+}
 
-    //calculate immediate dominator
-    if (print_id)
-        cout << "Immediate dominator computing:" << endl;
+void print_idom(ostream& os)
+{
+    os << "Immediate dominator computing:\n";
     for (auto &i : bbs)
-        i.idom = -1;
-    for (auto &i : bbs) {
-        if (i.name_id == ENTRY_ID)
-            continue;
-        bitvector tmp = i.dom;
-        tmp[i.name_id] = false;
-        vector<int> dom = tmp;
-        for (auto j : dom)
-            if (bbs[j].dom == tmp) {
-                i.idom = j;
-                break;
-            }
-        if (print_id)
-            cout << bb_names[i.name_id] << " idom: " << bb_names[i.idom] << endl;
-    }
-    if (print_id)
-        cout << endl;
-
-    //set succ for dominator tree
-    for (auto i : bbs)
-        if (i.idom > -1)
-            bbs[i.idom].succdom.push_back(i.name_id);
+        if (i.name_id != ENTRY_ID)
+            os << bb_names[i.name_id] << " idom: " << bb_names[dom_tree.idom(i.name_id)] << '\n';
+    os << '\n';
+}
 
-    //calculate dominance frontier
+//-DF: joins are visited in increasing order so every frontier comes out sorted
+//and a repeat can only be the last entry
+void print_frontier(ostream& os)
+{
+    int p = bbs.size();
+    vector<vector<int> > df(p);
     for (auto &i : bbs) {
-        i.df = bitvector(p);
-        if (i.pred.size() < 2)
+        if (flow_graph.pred(i.name_id).size() < 2 || !dom_tree.reachable(i.name_id))
             continue;
-        for (auto p : i.pred) {
-            int r = p;
-            while (r != i.idom) {
-                bbs[r].df[i.name_id] = true;
-                r = bbs[r].idom;
-            }
+        for (auto p : flow_graph.pred(i.name_id)) {
+            if (!dom_tree.reachable(p))
+                continue;
+            for (int r = p; r != dom_tree.idom(i.name_id); r = dom_tree.idom(r))
+                if (df[r].empty() || df[r].back() != i.name_id)
+                    df[r].push_back(i.name_id);
         }
     }
-    if (print_df) {
-        cout << "Dominance frontier sets:" << endl;
-        for (auto i : bbs)
-            cout << bb_names[i.name_id] << ": " << print_bb_names(i.df) << endl;
-        cout << endl;
-    }
+    os << "Dominance frontier sets:\n";
+    for (auto &i : bbs)
+        os << bb_names[i.name_id] << ": " << print_bb_names(df[i.name_id]) << '\n';
+    os << '\n';
+}
+
+//fewest variables worth a chunk of parallel phi placement
+const size_t phi_chunk_min_vars = 64;
 
-    //calculate globals, blocks sets
+//phi insertion, with -pruned a phi is placed only where its variable is in var_live_in
+void place_phi()
+{
+    int p = bbs.size();
+    //calculate globals, blocks defining each variable in increasing order
+    int t = var_names.size();
     bitvector globals(t);
-    vector<bitvector> blocks;
-    blocks.assign(t, bitvector(p));
-    for (auto i : bbs) {
+    vector<vector<int> > def_blocks(t);
+    for (auto &i : bbs) {
         if (i.name_id == ENTRY_ID || i.name_id ==EXIT_ID)
             continue;
         bitvector def_tmp(t);
@@ -840,194 +1118,1298 @@ print_id = 0, print_df = 0, print_ssa = 0;
                 globals[ins_list[j].r_id1] = true;
             if (ins_list[j].r_id2 > -1 && def_tmp[ins_list[j].r_id2] == false)
                 globals[ins_list[j].r_id2] = true;
+            if (def_blocks[ins_list[j].l_id].empty() || def_blocks[ins_list[j].l_id].back() != i.name_id)
+                def_blocks[ins_list[j].l_id].push_back(i.name_id);
             def_tmp[ins_list[j].l_id] = true;
-            blocks[ins_list[j].l_id][i.name_id] = true;
         }
     }
 
-    //insert phi
-    for (auto i : (vector<int>)globals) {
-        bitvector worklist = blocks[i];
-        bitvector used_blocks(p);
-        vector<int> tmp = worklist;
-        int k = 1;
-        while (!tmp.empty()) {
-            int b = tmp.front();
-            for (auto d : (vector<int>)bbs[b].df) {
-                if (used_blocks[d])
-                    continue;
-                bbs[d].phi_list.push_back({i, i});
-                used_blocks[d] = worklist[d] = true;
-            }
-            worklist[b] = false;
-            tmp = worklist;
+    //insert phi at the iterated dominance frontier of the defining blocks,
+    //with -j runs of variables are placed on the workers into their own lists
+    //of (block, variable) sites, appended in variable order as on one thread
+    vector<int> vars;
+    for (auto i : globals)
+        vars.push_back(i);
+    int chunks = 1;
+    if (pool)
+        chunks = max((size_t)1, min((size_t)pool->size() * 4, vars.size() / phi_chunk_min_vars));
+    vector<vector<pair<int, int> > > sites(chunks);
+    const cfg &g = flow_graph;
+    const domtree &tree = dom_tree;
+    const vector<vector<int> > &live_in = var_live_in;
+    bool pruned = use_pruned;
+    auto place = [&](int c){
+        idf_calculator idf(g, tree);
+        vector<int> phi_blocks;
+        vector<int> live_mark(pruned ? p : 0, -1);
+        for (size_t k = vars.size() * c / chunks; k < vars.size() * (c + 1) / chunks; ++k) {
+            int i = vars[k];
+            if (pruned) {
+                for (auto b : live_in[i])
+                    live_mark[b] = i;
+                idf.calculate(def_blocks[i], [&](int b){ return live_mark[b] == i; }, phi_blocks);
+            } else
+                idf.calculate(def_blocks[i], phi_blocks);
+            for (auto d : phi_blocks)
+                sites[c].push_back(make_pair(d, i));
         }
-    }
+    };
+    if (chunks > 1)
+        pool->parallel_for(chunks, place);
+    else
+        place(0);
+    for (auto &c : sites)
+        for (auto &i : c)
+            bbs[i.first].phi_list.push_back({i.second, i.second});
+}
 
-    //rename vars
+//rename vars
+void construct_ssa()
+{
+    int t = var_names.size();
     var_counter.assign(t, 0);
     var_stack.resize(t);
-    for (auto i : (vector<int>)bbs[ENTRY_ID].out_lv)
+    for (auto i : entry_live)
         newname(i);
     rename(ENTRY_ID);
+}
 
-    //print semi-pruned SSA form without deadcode
-    if (print_ssa)
-        for (auto i : bbs) {
-            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
-                continue;
-            cout << bb_names[i.name_id] << endl;
-            for (int j = i.first_ins; j <= i.last_ins; ++j)
-                if (ins_list[j].type == LABEL)
-                    cout << ins_list[j].str << endl;
-                else
-                    break;
-            for (auto j : i.phi_list) {
-                    cout << var_names[j.var_id] << " = phi(";
-                    int s = j.var_ids.size();
-                    for (int k = 0; k < s; ++k) {
-                        cout << var_names[j.var_ids[k]];
-                        if (k < s - 1)
-                            cout << ", ";
+//lines of the input parsed on their own: names are numbered by the chunk's own tables
+//and renumbered when the chunks are merged in source order
+struct parse_chunk
+{
+    enum diag_kind
+    {
+        BAD_TOKENS, //wrong number of tokens, parsing goes on
+        BAD_ELSE,   //else without ifTrue, parsing stops
+        CHECK_ELSE  //else whose ifTrue would be in an earlier chunk
+    };
+
+    struct diag
+    {
+        diag_kind kind;
+        int ins, tokens;
+        strview line;
+    };
+
+    const char *begin, *end;
+    vector<ins> list;
+    interner vars, labels;
+    vector<pair<int, int> > label_defs; //label, ins
+    vector<diag> diags;
+};
+
+//operand slot k (0 l_id, 1 r_id1, 2 r_id2) of i from token t, an immediate or a variable
+void set_operand(interner& vars, ins& i, int k, strview t)
+{
+    int &id = k == 0 ? i.l_id : k == 1 ? i.r_id1 : i.r_id2;
+    if (is_number(t)) {
+        i.kind[k] = IMM_OPND;
+        i.imm[k] = t;
+        id = -1;
+    } else {
+        i.kind[k] = VAR_OPND;
+        id = vars.intern(t);
+    }
+}
+
+void parse_lines(parse_chunk& c)
+{
+    vector<strview> tokens;
+    strview line;
+    for (const char *p = c.begin; next_line(p, c.end, line);) {
+        int cur_ins = c.list.size();
+        tokenize(line, tokens);
+        if (tokens.empty())
+            continue;
+        ins i = ins();
+        i.ins_id = cur_ins;
+        i.str = line;
+        i.ins_label = tokens.back();
+        i.id = i.l_id = i.r_id1 = i.r_id2 = -1;
+        i.opcode = tokens[0];
+        strview k1, k2;
+        switch (tokens.size()) {
+            case 2:
+                //else, label or ifTrue without parameters
+                if (tokens[0] == "else") {
+                    //ins[cur_ins - 2] must exist and have IF type, it is checked in the merge
+                    //when it is in an earlier chunk
+                    if (cur_ins - 2 < 0)
+                        c.diags.push_back({parse_chunk::CHECK_ELSE, cur_ins, 2, line});
+                    else if (c.list[cur_ins - 2].type != IF) {
+                        c.diags.push_back({parse_chunk::BAD_ELSE, cur_ins, 2, line});
+                        return;
                     }
-                    cout << ")" << endl;
-            }
-            for (int j = i.first_ins; j <= i.last_ins; ++j) {
-                if (ins_list[j].type == LABEL)
-                    continue;
-                istringstream iss(ins_list[j].str);
-                vector<string> tokens{istream_iterator<string>{iss}, istream_iterator<string>{}};
-                string k1, k2;
-                switch (ins_list[j].type) {
-                    case EXIT_JUMP:
-                            cout << tokens[0] << " "
-                            << (is_number(tokens[1]) ? tokens[1] : var_names[ins_list[j].r_id1]) << " "
-                            << tokens[2] << endl;
-                            break;
-                    case IF:
-                        cout << tokens[0] << " "
-                        << (is_number(tokens[1]) ? tokens[1] : var_names[ins_list[j].r_id1]) << " "
-                        << tokens[2] << " "
-                        << (is_number(tokens[3]) ? tokens[3] : var_names[ins_list[j].r_id2]) << " "
-                        << tokens[4] << endl;
-                        break;
-                    case OP:
-                        if (tokens.size() == 4) {//unary
-                            if (is_array_element(tokens[0], k1, k2)) //in left part array element k1[k2]
-                                cout << (is_number(k1) ? k1 : var_names[ins_list[j].l_id]) << "["
-                                << (is_number(k2) ? k2 : var_names[ins_list[j].r_id1]) << "] "
-                                << tokens[1] << " "
-                                << (is_number(tokens[2]) ? tokens[2] : var_names[ins_list[j].r_id2]) << " "
-                                << tokens[3] << endl;
-                            else if (is_array_element(tokens[2], k1, k2)) //in right part array element k1[k2]
-                                cout << (is_number(tokens[0]) ? tokens[0] : var_names[ins_list[j].l_id]) << " "
-                                << tokens[1] << " "
-                                << (is_number(k1) ? k1 : var_names[ins_list[j].r_id1]) << "["
-                                << (is_number(k2) ? k2 : var_names[ins_list[j].r_id2]) << "] "
-                                << tokens[3] << endl;
-                            else
-                                cout << (is_number(tokens[0]) ? tokens[0] : var_names[ins_list[j].l_id]) << " "
-                                << tokens[1] << " "
-                                << (is_number(tokens[2]) ? tokens[2] : var_names[ins_list[j].r_id1]) << " "
-                                << tokens[3] << endl;
-                        } else //binary
-                            cout << (is_number(tokens[0]) ? tokens[0] : var_names[ins_list[j].l_id]) << " "
-                                << tokens[1] << " " << tokens[2] << " "
-                                << (is_number(tokens[3]) ? tokens[3] : var_names[ins_list[j].r_id1]) << " "
-                                << (is_number(tokens[4]) ? tokens[4] : var_names[ins_list[j].r_id2]) << " "
-                                << tokens[5] << endl;
-                        break;
-                    default:
-                        cout << ins_list[j].str << endl;
+                    i.type = ELSE;
+                } else if (tokens[0] == "ifTrue")
+                    i.type = IF;
+                else {
+                    i.type = LABEL;
+                    i.id = c.labels.intern(tokens[0]);
+                    c.label_defs.push_back(make_pair(i.id, cur_ins));
                 }
-            }
-            cout << endl;
+                break;
+            case 3:
+                //goto, return
+                if (tokens[0] == "goto") {
+                    i.type = LABEL_JUMP;
+                    i.id = c.labels.intern(tokens[1]);
+                    i.oper = tokens[1];
+                } else {
+                    i.type = EXIT_JUMP;
+                    set_operand(c.vars, i, 1, tokens[1]);
+                }
+                break;
+            case 4:
+                //unary operation
+                i.type = OP;
+                i.opcode = tokens[1];
+                if (is_array_element(tokens[0], k1, k2)) { //in left part array element k1[k2]
+                    i.array = ARRAY_LEFT;
+                    set_operand(c.vars, i, 0, k1);
+                    set_operand(c.vars, i, 1, k2);
+                    set_operand(c.vars, i, 2, tokens[2]);
+                } else if (is_array_element(tokens[2], k1, k2)) { //in right part array element k1[k2]
+                    i.array = ARRAY_RIGHT;
+                    set_operand(c.vars, i, 0, tokens[0]);
+                    set_operand(c.vars, i, 1, k1);
+                    set_operand(c.vars, i, 2, k2);
+                } else {
+                    set_operand(c.vars, i, 0, tokens[0]);
+                    set_operand(c.vars, i, 1, tokens[2]);
+                }
+                break;
+            case 5:
+                //ifTrue with 2 variables in condition
+                i.type = IF;
+                i.oper = tokens[2];
+                set_operand(c.vars, i, 1, tokens[1]);
+                set_operand(c.vars, i, 2, tokens[3]);
+                break;
+            case 6:
+                //binary operation
+                i.type = OP;
+                i.opcode = tokens[1];
+                i.oper = tokens[2];
+                set_operand(c.vars, i, 0, tokens[0]);
+                set_operand(c.vars, i, 1, tokens[3]);
+                set_operand(c.vars, i, 2, tokens[4]);
+                break;
+            default:
+                //some error
+                c.diags.push_back({parse_chunk::BAD_TOKENS, cur_ins, (int)tokens.size(), line});
+                continue;
         }
+        c.list.push_back(i);
+    }
+}
 
-//TEX format
-cout << "\\documentclass{article}\n\\usepackage{amsmath}\n\\usepackage[left=25mm, top=5mm, right=90mm, bottom=5mm, nohead, nofoot]{geometry}\n\\begin{document}\n";
-    if (1)
-        for (auto i : bbs) {
+//append the chunks to ins_list in source order, new names get global ids in order of
+//their first appearance as a serial parse would give them, false on errors
+bool merge_chunks(vector<parse_chunk>& chunks, vector<int>& labels_to_ins_id)
+{
+    bool errfl = false;
+    for (auto &c : chunks) {
+        int base = ins_list.size();
+        for (auto &d : c.diags)
+            switch (d.kind) {
+                case parse_chunk::BAD_TOKENS:
+                    *diag << d.tokens << ":'" << d.line << "'" << endl;
+                    errfl = true;
+                    break;
+                case parse_chunk::CHECK_ELSE:
+                    if (base + d.ins - 2 >= 0 && ins_list[base + d.ins - 2].type == IF)
+                        break;
+                    //falls through
+                case parse_chunk::BAD_ELSE:
+                    *diag << "Error: unexpected command 'else' in a line '" << d.line << "'" << endl;
+                    return false;
+            }
+        vector<int> var_map(c.vars.size()), label_map(c.labels.size());
+        for (size_t i = 0; i < var_map.size(); ++i)
+            var_map[i] = var_names.intern(c.vars[i]);
+        for (size_t i = 0; i < label_map.size(); ++i)
+            label_map[i] = labels_names.intern(c.labels[i]);
+        for (auto i : c.list) {
+            i.ins_id += base;
+            if (i.type == LABEL || i.type == LABEL_JUMP)
+                i.id = label_map[i.id];
+            if (i.l_id > -1)
+                i.l_id = var_map[i.l_id];
+            if (i.r_id1 > -1)
+                i.r_id1 = var_map[i.r_id1];
+            if (i.r_id2 > -1)
+                i.r_id2 = var_map[i.r_id2];
+            ins_list.push_back(i);
+        }
+        labels_to_ins_id.resize(labels_names.size(), 0);
+        for (auto &i : c.label_defs)
+            labels_to_ins_id[label_map[i.first]] = base + i.second;
+    }
+    return !errfl;
+}
+
+//chunks of a parallel parse are at least this large
+const size_t parse_chunk_min = 1 << 20;
+
+//parse ir_text into ins_list, with -j N large inputs are split at line boundaries
+//into chunks that are parsed concurrently
+bool parse_input(vector<int>& labels_to_ins_id)
+{
+    const char *begin = ir_text.begin(), *end = ir_text.end();
+    size_t size = end - begin, n = 1;
+    if (pool)
+        n = max((size_t)1, min((size_t)pool->size() * 4, size / parse_chunk_min));
+    vector<parse_chunk> chunks(n);
+    const char *p = begin;
+    for (size_t i = 0; i < n; ++i) {
+        chunks[i].begin = p;
+        if (i + 1 < n) {
+            const char *q = max(p, begin + size / n * (i + 1));
+            q = (const char *)memchr(q, '\n', end - q);
+            p = q ? q + 1 : end;
+        } else
+            p = end;
+        chunks[i].end = p;
+    }
+    if (n > 1)
+        pool->parallel_for(n, [&](int i){parse_lines(chunks[i]);});
+    else
+        parse_lines(chunks[0]);
+    return merge_chunks(chunks, labels_to_ins_id);
+}
+
+//-edit: every line "N instruction" replaces instruction N (from 1) by one of the same
+//type, an operation, ifTrue or return, so the CFG keeps its shape. The blocks of the
+//edited instructions are added to blocks, false on errors
+bool apply_edits(const input_buffer& text, vector<int>& blocks)
+{
+    vector<strview> tokens;
+    strview line;
+    for (const char *p = text.begin(); next_line(p, text.end(), line);) {
+        tokenize(line, tokens);
+        if (tokens.empty())
+            continue;
+        string num = tokens[0];
+        char *e;
+        long k = strtol(num.c_str(), &e, 10);
+        if (*e || k < 1 || k > (long)ins_list.size() || tokens.size() < 2) {
+            *diag << "Error: bad edit '" << line << "'" << endl;
+            return false;
+        }
+        parse_chunk c;
+        c.begin = tokens[1].s;
+        c.end = line.s + line.n;
+        parse_lines(c);
+        ins &old = ins_list[k - 1];
+        if (!c.diags.empty() || c.list.size() != 1 || c.list[0].type != old.type ||
+                (old.type != OP && old.type != IF && old.type != EXIT_JUMP)) {
+            *diag << "Error: edit '" << line << "' must replace an operation, ifTrue or return by one of the same type" << endl;
+            return false;
+        }
+        ins i = c.list[0];
+        for (auto id : {&i.l_id, &i.r_id1, &i.r_id2})
+            if (*id > -1)
+                *id = var_names.intern(c.vars[*id]);
+        i.ins_id = old.ins_id;
+        i.bb_id = old.bb_id;
+        i.old_l_id = i.l_id;
+        i.def_id = old.def_id;
+        old = i;
+        blocks.push_back(i.bb_id);
+    }
+    return true;
+}
+
+//set bb_id and old_l_id for each ins
+void set_ins_blocks()
+{
+    for (int i = 2; i < bbs.size(); ++i)
+        for (int j = bbs[i].first_ins; j <= bbs[i].last_ins; ++j) {
+            ins_list[j].bb_id = bbs[i].name_id;
+            ins_list[j].old_l_id = ins_list[j].l_id;
+        }
+}
+
+//basic blocks, the CFG and the names of the bbs
+void build_cfg(vector<int>& labels_to_ins_id)
+{
+    //partition into bbs
+    labels_to_ins_id.resize(labels_names.size(), 0);
+    int n = ins_list.size();
+    bitvector leader(n);
+    bool next_leader = true;
+    for (auto &i : ins_list) {
+        switch (i.type) {
+            case OP:
+            case IF:
+            case LABEL:
+                if (next_leader)
+                    leader[i.ins_id] = true;
+            case ELSE:
+                next_leader = false;
+                break;
+            case EXIT_JUMP:
+                if (next_leader)
+                    leader[i.ins_id] = true;
+                next_leader = true;
+                break;
+            case LABEL_JUMP:
+                if (next_leader)
+                    leader[i.ins_id] = true;
+                else
+                    leader[labels_to_ins_id[i.id]] = true;
+                next_leader = true;
+        }
+    }
+    //leaders_before[j] is the number of leaders before ins j, so a jump to ins j
+    //goes to bb leaders_before[j] + 2, the first bb starting at j or later
+    vector<int> leaders_before(n + 1);
+    leaders_before[0] = 0;
+    for (int j = 0; j < n; ++j) {
+        leaders_before[j + 1] = leaders_before[j] + leader[j];
+        if (leader[j])
+            bbs.push_back({leaders_before[j] + 2, j, -1});
+        if (bbs.size() > 2 && (j + 1 == n || leader[j + 1]))
+            bbs.back().last_ins = j;
+    }
+    assert(bbs.size() > 2);
+    //edges in succ order of every bb, frozen into flow_graph
+    vector<pair<int, int> > edges;
+    edges.push_back(make_pair(ENTRY_ID, 2));//First real bb
+    for (auto &i : bbs) {
+        if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
+            continue;
+        bool fall_through = false;
+        int check_insns[2], check_count = 0;
+        //if (goto|return)
+        if (i.last_ins - 1 >= i.first_ins && ins_list[i.last_ins - 1].type == IF) {
+            check_insns[check_count++] = i.last_ins;
+            fall_through = true;
+        //if (goto|return) else (goto|return)
+        } else if (i.last_ins - 2 >= i.first_ins && ins_list[i.last_ins - 1].type == ELSE) {
+            check_insns[check_count++] = i.last_ins;
+            check_insns[check_count++] = i.last_ins - 2;
+        //(goto|return)
+        } else if (ins_list[i.last_ins].type == EXIT_JUMP || ins_list[i.last_ins].type == LABEL_JUMP)
+            check_insns[check_count++] = i.last_ins;
+        //other
+        else
+            fall_through = true;
+        for (int j = 0; j < check_count; ++j) {
+            if (ins_list[check_insns[j]].type == LABEL_JUMP) {
+                int k = leaders_before[labels_to_ins_id[ins_list[check_insns[j]].id]];
+                edges.push_back(make_pair(i.name_id, k + 2));
+            } else if (ins_list[check_insns[j]].type == EXIT_JUMP) {
+                edges.push_back(make_pair(i.name_id, EXIT_ID));
+            }
+        }
+        if (fall_through) {
+            int tmp = i.name_id == bbs.size() - 1 ? EXIT_ID : i.name_id + 1;
+            edges.push_back(make_pair(i.name_id, tmp));
+        }
+    }
+    flow_graph.build(bbs.size(), edges);
+    vector<pair<int, int> >().swap(edges);
+
+    //set BB labels
+    if (use_dfst) {
+        bb_names.resize(bbs.size());
+        vector<bool> visited;
+        visited.assign(bbs.size(), false);
+        visited[EXIT_ID] = true;
+        DFST(visited);
+    } else
+        for (int i = 2; i < bbs.size(); ++i)
+            bb_names.push_back(string("BB") + NumberToString(i - 1));
+
+    set_ins_blocks();
+}
+
+//an ins in a cache entry, its text as offsets into the input
+struct cached_ins
+{
+    int32_t ins_id, type, id, l_id, r_id1, r_id2, bb_id, old_l_id, def_id, array;
+    int32_t kind[3], pad;
+    //str, ins_label, opcode, oper and imm as offset and length
+    uint64_t text[7][2];
+};
+
+//names as the characters of all of them and the end of each one
+template<typename Names>
+void put_names(cache_writer& w, const Names& names, size_t n)
+{
+    vector<char> chars;
+    vector<uint64_t> ends;
+    for (size_t i = 0; i < n; ++i) {
+        strview s = names[i];
+        chars.insert(chars.end(), s.s, s.s + s.n);
+        ends.push_back(chars.size());
+    }
+    w.put(chars);
+    w.put(ends);
+}
+
+template<typename Add>
+void get_names(cache_reader& r, Add add)
+{
+    vector<char> chars;
+    vector<uint64_t> ends;
+    r.get(chars);
+    r.get(ends);
+    uint64_t b = 0;
+    for (auto e : ends) {
+        e = min(e, (uint64_t)chars.size());
+        add(strview(chars.data() + b, e - min(b, e)));
+        b = e;
+    }
+}
+
+//instructions, names and label targets of the parse pass
+void save_parse(cache_writer& w, const vector<int>& labels_to_ins_id)
+{
+    const char *base = ir_text.begin();
+    w.begin(CACHE_PARSE);
+    vector<cached_ins> list(ins_list.size());
+    for (size_t k = 0; k < ins_list.size(); ++k) {
+        const ins &i = ins_list[k];
+        cached_ins &c = list[k];
+        c = cached_ins();
+        c.ins_id = i.ins_id;
+        c.type = i.type;
+        c.id = i.id;
+        c.l_id = i.l_id;
+        c.r_id1 = i.r_id1;
+        c.r_id2 = i.r_id2;
+        c.bb_id = i.bb_id;
+        c.old_l_id = i.old_l_id;
+        c.def_id = i.def_id;
+        c.array = i.array;
+        const strview *text[7] = {&i.str, &i.ins_label, &i.opcode, &i.oper, &i.imm[0], &i.imm[1], &i.imm[2]};
+        for (int j = 0; j < 3; ++j)
+            c.kind[j] = i.kind[j];
+        //empty views need not point into the input
+        for (int j = 0; j < 7; ++j)
+            if (!text[j]->empty()) {
+                c.text[j][0] = text[j]->s - base;
+                c.text[j][1] = text[j]->n;
+            }
+    }
+    w.put(list);
+    put_names(w, var_names, var_names.size());
+    put_names(w, labels_names, labels_names.size());
+    w.put(vector<int32_t>(labels_to_ins_id.begin(), labels_to_ins_id.end()));
+}
+
+void load_parse(cache_reader& r, vector<int>& labels_to_ins_id)
+{
+    const char *base = ir_text.begin();
+    size_t size = ir_text.end() - base;
+    vector<cached_ins> list;
+    r.get(list);
+    ins_list.resize(list.size());
+    for (size_t k = 0; k < list.size(); ++k) {
+        const cached_ins &c = list[k];
+        ins &i = ins_list[k];
+        i.ins_id = c.ins_id;
+        i.type = (instype)c.type;
+        i.id = c.id;
+        i.l_id = c.l_id;
+        i.r_id1 = c.r_id1;
+        i.r_id2 = c.r_id2;
+        i.bb_id = c.bb_id;
+        i.old_l_id = c.old_l_id;
+        i.def_id = c.def_id;
+        i.array = (array_form)c.array;
+        strview *text[7] = {&i.str, &i.ins_label, &i.opcode, &i.oper, &i.imm[0], &i.imm[1], &i.imm[2]};
+        for (int j = 0; j < 3; ++j)
+            i.kind[j] = (opnd_kind)c.kind[j];
+        for (int j = 0; j < 7; ++j)
+            if (c.text[j][1] > 0 && c.text[j][0] <= size && c.text[j][1] <= size - c.text[j][0])
+                *text[j] = strview(base + c.text[j][0], c.text[j][1]);
+            else
+                *text[j] = strview();
+    }
+    get_names(r, [](strview s){ var_names.intern(s); });
+    get_names(r, [](strview s){ labels_names.intern(s); });
+    vector<int32_t> targets;
+    r.get(targets);
+    labels_to_ins_id.assign(targets.begin(), targets.end());
+}
+
+//blocks, edges and block names of the cfg pass
+void save_cfg(cache_writer& w)
+{
+    w.begin(CACHE_CFG);
+    vector<int32_t> blocks, edges;
+    for (auto &i : bbs) {
+        blocks.push_back(i.name_id);
+        blocks.push_back(i.first_ins);
+        blocks.push_back(i.last_ins);
+    }
+    for (auto &e : flow_graph.edge_list()) {
+        edges.push_back(e.first);
+        edges.push_back(e.second);
+    }
+    w.put(blocks);
+    w.put(edges);
+    put_names(w, bb_names, bb_names.size());
+}
+
+void load_cfg(cache_reader& r)
+{
+    vector<int32_t> blocks, edges;
+    r.get(blocks);
+    r.get(edges);
+    bbs.resize(blocks.size() / 3);
+    for (size_t b = 0; b < bbs.size(); ++b)
+        bbs[b] = {blocks[3 * b], blocks[3 * b + 1], blocks[3 * b + 2]};
+    vector<pair<int, int> > list;
+    for (size_t k = 0; k + 1 < edges.size(); k += 2)
+        list.push_back(make_pair(edges[k], edges[k + 1]));
+    flow_graph.build(bbs.size(), list);
+    bb_names.clear();
+    get_names(r, [](strview s){ bb_names.push_back(s); });
+    //the instructions may have been parsed again
+    set_ins_blocks();
+}
+
+//immediate dominators of the dom pass, the tree is numbered again from them
+void save_dom(cache_writer& w)
+{
+    w.begin(CACHE_DOM);
+    vector<int32_t> idom;
+    for (int b = 0; b < dom_tree.size(); ++b)
+        idom.push_back(dom_tree.idom(b));
+    w.put(idom);
+}
+
+void load_dom(cache_reader& r)
+{
+    vector<int32_t> idom;
+    r.get(idom);
+    dom_tree.build(vector<int>(idom.begin(), idom.end()), ENTRY_ID);
+}
+
+//file of the cache entry for an input in dir, options are the flags that change what is cached
+string cache_entry_path(const char *dir, uint64_t input_hash, uint32_t options)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx-%x.ccc", (unsigned long long)input_hash, options);
+    return string(dir) + "/" + name;
+}
+
+enum text_section
+{
+    IR_TEXT,
+    SETS_TEXT,
+    RD_TEXT, //written by the rd pass while it solves
+    LV_TEXT, //written by the lv pass while it solves
+    IO_TEXT,
+    DCE_TEXT,
+    DC_TEXT,
+    NL_TEXT,
+    ID_TEXT,
+    DF_TEXT,
+    SSA_TEXT
+};
+
+//the plain text dumps, one section per flag
+class text_emitter : public emitter
+{
+
+private:
+    text_section section_;
+
+    //IR with BB labels
+    void ir(ostream& os)
+    {
+        for (auto &i : bbs) {
             if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
                 continue;
-            cout << bb_names[i.name_id] << endl << endl;
-            for (int j = i.first_ins; j <= i.last_ins; ++j) {
-                istringstream iss(ins_list[j].str);
-                vector<string> tokens{istream_iterator<string>{iss}, istream_iterator<string>{}};
+            os << bb_names[i.name_id] << '\n';
+            for (int j = i.first_ins; j <= i.last_ins; ++j)
+                os << ins_list[j].str << '\n';
+            os << '\n';
+        }
+    }
+
+    //semi-pruned (pruned with -pruned) SSA form without deadcode
+    void ssa(ostream& os)
+    {
+        for (auto &i : bbs) {
+            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
+                continue;
+            os << bb_names[i.name_id] << '\n';
+            for (int j = i.first_ins; j <= i.last_ins; ++j)
                 if (ins_list[j].type == LABEL)
-                    cout << "\\textbf{" << tokens[0] << ":" << "\\hfill{" << tokens[1] << "}}" << endl << endl;
+                    os << ins_list[j].str << '\n';
                 else
                     break;
-            }
-            for (auto j : i.phi_list) {
-                    cout << "\\(" << var_names[j.var_id] << " = \\phi(";
+            for (auto &j : i.phi_list) {
+                    os << var_names[j.var_id] << " = phi(";
                     int s = j.var_ids.size();
                     for (int k = 0; k < s; ++k) {
-                        cout << var_names[j.var_ids[k]];
+                        os << var_names[j.var_ids[k]];
                         if (k < s - 1)
-                            cout << ", ";
+                            os << ", ";
                     }
-                    cout << ")\\)" << endl << endl;
+                    os << ")\n";
             }
-            for (int j = i.first_ins; j <= i.last_ins; ++j) {
+            for (int j = i.first_ins; j <= i.last_ins; ++j)
+                if (ins_list[j].type != LABEL)
+                    os << print_ssa_ins(ins_list[j]) << '\n';
+            os << '\n';
+        }
+    }
+
+public:
+    text_emitter(text_section section, const vector<int>& needs) : emitter(needs), section_(section) {}
+
+    void emit(ostream& os)
+    {
+        int p = bbs.size();
+        switch (section_) {
+            case IR_TEXT:
+                ir(os);
+                break;
+            case SETS_TEXT:
+                dataflow->print_sets(os);
+                break;
+            case IO_TEXT:
+                dataflow->print_io(os);
+                break;
+            case DCE_TEXT:
+                dataflow->print_dead_code(os);
+                break;
+            case DC_TEXT:
+                //small CFGs keep the traced dominator sets inline in one or two words
+                if (p <= 64)
+                    trace_dominators<fixedset<64> >(os);
+                else if (p <= 128)
+                    trace_dominators<fixedset<128> >(os);
+                else
+                    trace_dominators<bitvector>(os);
+                break;
+            case NL_TEXT:
+                print_loops(os);
+                break;
+            case ID_TEXT:
+                print_idom(os);
+                break;
+            case DF_TEXT:
+                print_frontier(os);
+                break;
+            case SSA_TEXT:
+                ssa(os);
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+//-G: digraph for graphviz dot
+class dot_emitter : public emitter
+{
+
+public:
+    dot_emitter(const vector<int>& needs) : emitter(needs) {}
+
+    void emit(ostream& os)
+    {
+        os << "digraph G {\n";
+        for (auto &i : bbs)
+            for (auto j : flow_graph.succ(i.name_id))
+                os << "	" << bb_names[i.name_id] << " -> " << bb_names[j] << ";\n";
+        os << "}\n\n";
+    }
+};
+
+//-serialize: the baseBlocks list, preds and succs by block index,
+//assigned and accessed variables by name
+class serialize_emitter : public emitter
+{
+
+private:
+    template<typename Range, typename Item>
+    void list(ostream& os, const Range& r, Item item)
+    {
+        bool first = true;
+        for (auto j : r) {
+            if (!first)
+                os << ", ";
+            first = false;
+            item(j);
+        }
+    }
+
+public:
+    serialize_emitter(const vector<int>& needs) : emitter(needs) {}
+
+    void emit(ostream& os)
+    {
+        vector<int> vars;
+        auto index = [&](int j){ os << j; };
+        auto name = [&](int j){ os << "'" << var_names[j] << "'"; };
+        os << "baseBlocks = [\n";
+        bool first = true;
+        for (auto &i : bbs) {
+            if (!first)
+                os << ",\n";
+            first = false;
+            os << "    {\n";
+            os << "        'letter' : '" << bb_names[i.name_id] << "',\n";
+            os << "        'pred' : [";
+            list(os, flow_graph.pred(i.name_id), index);
+            os << "],\n";
+            os << "        'succ' : [";
+            list(os, flow_graph.succ(i.name_id), index);
+            os << "],\n";
+            os << "        'assign' : [";
+            dataflow->vars(DEF_SET, i.name_id, vars);
+            list(os, vars, name);
+            os << "],\n";
+            os << "        'access' : [";
+            dataflow->vars(USE_SET, i.name_id, vars);
+            list(os, vars, name);
+            os << "]\n";
+            os << "    }";
+        }
+        os << "\n]\n\n";
+    }
+};
+
+//-tex: the SSA form as a TeX document
+class tex_emitter : public emitter
+{
+
+public:
+    tex_emitter(const vector<int>& needs) : emitter(needs) {}
+
+    void emit(ostream& os)
+    {
+        os << "\\documentclass{article}\n\\usepackage{amsmath}\n\\usepackage[left=25mm, top=5mm, right=90mm, bottom=5mm, nohead, nofoot]{geometry}\n\\begin{document}\n";
+        for (auto &i : bbs) {
+            if (i.name_id == ENTRY_ID || i.name_id == EXIT_ID)
+                continue;
+            os << bb_names[i.name_id] << "\n\n";
+            for (int j = i.first_ins; j <= i.last_ins; ++j)
                 if (ins_list[j].type == LABEL)
-                    continue;
-                istringstream iss(ins_list[j].str);
-                vector<string> tokens{istream_iterator<string>{iss}, istream_iterator<string>{}};
-                string k1, k2;
-                switch (ins_list[j].type) {
-                    case EXIT_JUMP:
-                            cout << tokens[0] << " \\("
-                            << (is_number(tokens[1]) ? tokens[1] : var_names[ins_list[j].r_id1]) << "\\hfill{"
-                            << tokens[2] << "}\\)" << endl << endl;
-                            break;
-                    case IF:
-                        cout << tokens[0] << " \\("
-                        << (is_number(tokens[1]) ? tokens[1] : var_names[ins_list[j].r_id1]) << " "
-                        << tokens[2] << " "
-                        << (is_number(tokens[3]) ? tokens[3] : var_names[ins_list[j].r_id2]) << " "
-                        << "\\hfill{" << tokens[4] << "}\\)" << endl << endl;
-                        break;
-                    case OP:
-                        if (tokens.size() == 4) {//unary
-                            if (is_array_element(tokens[0], k1, k2)) //in left part array element k1[k2]
-                                cout << "\\(" << (is_number(k1) ? k1 : var_names[ins_list[j].l_id]) << "["
-                                << (is_number(k2) ? k2 : var_names[ins_list[j].r_id1]) << "] "
-                                << tokens[1] << " "
-                                << (is_number(tokens[2]) ? tokens[2] : var_names[ins_list[j].r_id2]) << " "
-                                << "\\hfill{" << tokens[3] << "}\\)" << endl << endl;
-                            else if (is_array_element(tokens[2], k1, k2)) //in right part array element k1[k2]
-                                cout << "\\(" << (is_number(tokens[0]) ? tokens[0] : var_names[ins_list[j].l_id]) << " "
-                                << tokens[1] << " "
-                                << (is_number(k1) ? k1 : var_names[ins_list[j].r_id1]) << "["
-                                << (is_number(k2) ? k2 : var_names[ins_list[j].r_id2]) << "] "
-                                << "\\hfill{" << tokens[3] << "}\\)" << endl << endl;
-                            else
-                                cout << "\\(" << (is_number(tokens[0]) ? tokens[0] : var_names[ins_list[j].l_id]) << " "
-                                << tokens[1] << " "
-                                << (is_number(tokens[2]) ? tokens[2] : var_names[ins_list[j].r_id1]) << " "
-                                << "\\hfill{" << tokens[3] << "}\\)" << endl << endl;
-                        } else //binary
-                            cout << "\\(" << (is_number(tokens[0]) ? tokens[0] : var_names[ins_list[j].l_id]) << " "
-                                << tokens[1] << " " << tokens[2] << ",\\ "
-                                << (is_number(tokens[3]) ? tokens[3] : var_names[ins_list[j].r_id1]) << ", "
-                                << (is_number(tokens[4]) ? tokens[4] : var_names[ins_list[j].r_id2]) << " "
-                                << "\\hfill{" << tokens[5] << "}\\)" << endl << endl;
-                        break;
-                    case LABEL_JUMP:
-                        //cout << "\\quad \\textbf{" << ins_list[j].str << "}" << endl << endl;
-                        cout << "\\quad \\textbf{" << tokens[0] << "\\ " << tokens[1] << "\\hfill{" << tokens[2] << "}}" << endl << endl; 
-                        break;
-                    case ELSE:
-                        cout << tokens[0] << "\\hfill{" << tokens[1] << "}" << endl << endl; 
-                        break;
-                    default:
-                        cout << ins_list[j].str << endl << endl;
-                }
+                    os << print_tex_ins(ins_list[j]) << "\n\n";
+                else
+                    break;
+            for (auto &j : i.phi_list) {
+                    os << "\\(" << var_names[j.var_id] << " = \\phi(";
+                    int s = j.var_ids.size();
+                    for (int k = 0; k < s; ++k) {
+                        os << var_names[j.var_ids[k]];
+                        if (k < s - 1)
+                            os << ", ";
+                    }
+                    os << ")\\)\n\n";
             }
-            cout << "\\vspace{5mm}" << endl << endl;
+            for (int j = i.first_ins; j <= i.last_ins; ++j)
+                if (ins_list[j].type != LABEL)
+                    os << print_tex_ins(ins_list[j]) << "\n\n";
+            os << "\\vspace{5mm}\n\n";
         }
-    cout << "\\end{document}" << endl << endl;
+        os << "\\end{document}\n\n";
+    }
+};
 
+//-json: every block with its source instructions, preds and succs by name,
+//immediate dominator (null for entry and unreachable blocks) and its lv sets
+class json_emitter : public emitter
+{
+
+private:
+    template<typename Range, typename Name>
+    void names(ostream& os, const char *key, const Range& r, Name name)
+    {
+        os << "            \"" << key << "\": [";
+        bool first = true;
+        for (auto j : r) {
+            if (!first)
+                os << ", ";
+            first = false;
+            os << print_json_string(name(j));
+        }
+        os << "]";
+    }
+
+public:
+    json_emitter(const vector<int>& needs) : emitter(needs) {}
+
+    void emit(ostream& os)
+    {
+        vector<int> vars;
+        auto bb_name = [](int b){ return strview(bb_names[b]); };
+        auto var_name = [](int v){ return var_names[v]; };
+        auto ins_text = [](int j){ return ins_list[j].str; };
+        static const char *set_keys[] = {"use", "def", "live_in", "live_out"};
+        os << "{\n    \"blocks\": [";
+        bool first = true;
+        for (auto &i : bbs) {
+            int b = i.name_id;
+            os << (first ? "\n" : ",\n");
+            first = false;
+            os << "        {\n";
+            os << "            \"name\": " << print_json_string(bb_names[b]) << ",\n";
+            vector<int> text;
+            if (b != ENTRY_ID && b != EXIT_ID)
+                for (int j = i.first_ins; j <= i.last_ins; ++j)
+                    text.push_back(j);
+            names(os, "ins", text, ins_text);
+            os << ",\n";
+            names(os, "pred", flow_graph.pred(b), bb_name);
+            os << ",\n";
+            names(os, "succ", flow_graph.succ(b), bb_name);
+            os << ",\n";
+            os << "            \"idom\": ";
+            if (dom_tree.idom(b) == -1)
+                os << "null";
+            else
+                os << print_json_string(bb_names[dom_tree.idom(b)]);
+            for (int k = USE_SET; k <= LIVE_OUT_SET; ++k) {
+                os << ",\n";
+                dataflow->vars((var_set_kind)k, b, vars);
+                names(os, set_keys[k], vars, var_name);
+            }
+            os << "\n        }";
+        }
+        os << "\n    ]\n}\n";
+    }
+};
+
+//clear the state of the last run on this thread
+void reset_state()
+{
+    ir_text.close();
+    ins_list.clear();
+    labels_names.clear();
+    bb_names.clear();
+    var_names.clear();
+    bbs.clear();
+    flow_graph = cfg();
+    dom_tree = domtree();
+    loop_tree = loop_forest();
+    all_def.clear();
+    var_defs.clear();
+    var_counter.clear();
+    var_stack.clear();
+    entry_live.clear();
+    var_live_in.clear();
+    dataflow.reset();
+    use_dfst = use_sparse = use_pruned = all = print_ir = print_graph = print_sets = print_serialize =
+        print_rd = print_lv = print_io = print_dce = print_dc = print_nl = print_tex = print_json =
+        print_stats = print_time_passes = 0;
+    print_id = print_df = print_ssa = 1;
+    num_threads = 1;
+    pool = NULL;
+}
+
+int run(int argc, char* argv[], streambuf *request);
+
+//a -server request runs as the command line with its options would,
+//with its input and output going through the socket
+int handle_request(server_request& r, ostream& out, ostream& err)
+{
+    reset_state();
+    ir_text.adopt(r.text);
+    string name = "ccc";
+    vector<char *> argv(1, &name[0]);
+    for (auto &a : r.args)
+        argv.push_back(&a[0]);
+    argv.push_back(NULL);
+    diag = &err;
+    int status = run(argv.size() - 1, argv.data(), out.rdbuf());
+    diag = &cerr;
+    reset_state();
+    return status;
+}
+
+//getopt keeps its state in globals
+mutex options_m;
+
+//one run for the options in argv. A -server request passes the stream buffer its
+//output goes to, its input is already in ir_text and -i, -o, -j, -server are refused
+int run(int argc, char* argv[], streambuf *request)
+{
+    //parse args
+    char *input = NULL, *output = NULL, *cache_dir = NULL, *edits = NULL, *server = NULL;
+    bool threads_set = false;
+    unique_lock<mutex> options_lock(options_m);
+    //start over for every run, requests print their own errors
+    optind = 0;
+    opterr = !request;
+    for (;;) {
+        struct option longopts[] =
+        {
+            { "help", no_argument, 0, 'h' },
+            { "usage", no_argument, 0, 'u' },
+            { "cache", required_argument, 0, 'c' },
+            { "edit", required_argument, 0, 'e' },
+            { "server", required_argument, 0, 's' },
+            { "dfst", no_argument, &use_dfst, 1 },
+            { "sparse", no_argument, &use_sparse, 1 },
+            { "pruned", no_argument, &use_pruned, 1 },
+            { "ALL", no_argument, &all, 1 },
+            { "IR", no_argument, &print_ir, 1 },
+            { "G", no_argument, &print_graph, 1 },
+            { "sets", no_argument, &print_sets, 1 },
+            { "serialize", no_argument, &print_serialize, 1 },
+            { "RD", no_argument, &print_rd, 1 },
+            { "LV", no_argument, &print_lv, 1 },
+            { "IO", no_argument, &print_io, 1 },
+            { "dce", no_argument, &print_dce, 1 },
+            { "DC", no_argument, &print_dc, 1 },
+            { "NL", no_argument, &print_nl, 1 },
+            { "tex", no_argument, &print_tex, 1 },
+            { "json", no_argument, &print_json, 1 },
+            { "stats", no_argument, &print_stats, 1 },
+            { "time-passes", no_argument, &print_time_passes, 1 },
+            { 0,0,0,0 }
+        };
+        int optidx = 0;
+        int c = getopt_long_only(argc, argv, "hui:o:j:", longopts, &optidx);
+        if (c == -1)
+            break;
+#define all_coms " [-i INPUTFILE] [-o OUTPUTFILE] [-j N] [-cache DIR] [-edit FILE] \\
+[-server SOCKET] [-h] [-help] [-u] [-usage] [-dfst] [-sparse] [-pruned] [-ALL] \\
+[-IR] [-G] [-sets] [-serialize] [-RD] [-LV] [-IO] [-dce] [-DC] [-NL] [-tex] \\
+[-json] [-stats] [-time-passes]"
+        switch (c) {
+            case 0:
+                break;
+            case 'h':
+                *diag << "Usage: " << argv[0] << all_coms << "\n"
+                << "Options:\n"
+                << "\t-h,-help\t\tShow this help list\n"
+                << "\t-u,-usage\t\tShow a short usage message\n"
+                << "\t-i <INPUTFILE>\t\tRead from INPUTFILE\n"
+                << "\t-o <OUTPUTFILE>\t\tWrite to OUTPUTFILE\n"
+                << "\t-j <N>\t\t\tSolve RD and LV on N threads, with -server serve N requests at once\n"
+                << "\t-cache <DIR>\t\tKeep the parsed CFG and analysis results in DIR by input hash\n"
+                << "\t-edit <FILE>\t\tAnalyze, replace the instructions listed in FILE and update RD and LV\n"
+                << "\t-server <SOCKET>\tServe requests on the Unix socket SOCKET, a header line\n"
+                << "\t\t\t\t'<IR size> <options>' and the IR, answered by a line\n"
+                << "\t\t\t\t'<exit status> <output size> <diagnostics size>',\n"
+                << "\t\t\t\tthe output and the diagnostics\n"
+                << "\t-dfst\t\t\tUse DFST algorithm for BBs numeration\n"
+                << "\t-sparse\t\t\tUse sparse sets for RD and LV\n"
+                << "\t-pruned\t\t\tPlace phi only where the variable is live (pruned SSA)\n"
+                << "\t-ALL\t\t\tPrint all (union of all the following flags)\n"
+                << "\t-IR\t\t\tPrint IR with BB labels\n"
+                << "\t-G\t\t\tPrint digraph for graphviz dot\n"
+                << "\t-sets\t\t\tPrint gen, kill, use, def sets for all BBs\n"
+                << "\t-serialize\t\tPrint serialized info about BBs\n"
+                << "\t-RD\t\t\tPrint reaching definitions analysis\n"
+                << "\t-LV\t\t\tPrint live variable analysis\n"
+                << "\t-IO\t\t\tPrint Input Output sets for all BBs\n"
+                << "\t-dce\t\t\tPrint IR dead code and IR without dead code\n"
+                << "\t-DC\t\t\tPrint dominator sets for all BBs\n"
+                << "\t-NL\t\t\tPrint the loop nesting forest\n"
+                << "\t-tex\t\t\tPrint the SSA form as a TeX document\n"
+                << "\t-json\t\t\tPrint BBs with their edges, idom and LV sets as JSON\n"
+                << "\t-stats\t\t\tPrint solver iteration and visit counts to stderr\n"
+                << "\t-time-passes\t\tPrint the time of every analysis pass to stderr"
+                << endl;
+                return 0;
+            case 'u':
+                *diag << "Usage: " << argv[0] << all_coms << endl;
+                return 0;
+            case 'i':
+                if (input)
+                    *diag << "Warning: set new input file '" << optarg << "'" << endl;
+                input = optarg;
+                break;
+            case 'o':
+                if (output)
+                    *diag << "Warning: set new output file '" << optarg << "'" << endl;
+                output = optarg;
+                break;
+            case 'c':
+                cache_dir = optarg;
+                break;
+            case 'e':
+                edits = optarg;
+                break;
+            case 's':
+                server = optarg;
+                break;
+            case 'j':
+                num_threads = atoi(optarg);
+                threads_set = true;
+                if (num_threads < 1) {
+                    *diag << "Error: bad number of threads '" << optarg << "'" << endl;
+                    return 1;
+                }
+                break;
+            case '?':
+                if (request)
+                    *diag << "Error: bad option '" << argv[optind - 1] << "'" << endl;
+                *diag << "Try '" << argv[0] << " -help' or '" << argv[0] << " -usage' for more information" << endl;
+                return 1;
+            default:
+                return 1;
+        }
+    }
+    options_lock.unlock();
+    if (request && (input || output || threads_set || server)) {
+        *diag << "Error: -i, -o, -j and -server cannot be used in a -server request" << endl;
+        return 1;
+    }
+    if (server) {
+        if (!serve(server, threads_set ? num_threads : max(1u, thread::hardware_concurrency()), handle_request)) {
+            *diag << "Error: cannot serve on '" << server << "': " << strerror(errno) << endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (!(all || print_ir || print_graph || print_sets || print_serialize || print_rd || print_lv || print_io || print_dce || print_dc || print_nl || print_tex || print_json)) {
+        *diag << "Error: No any requests (output opts)\nTry '" << argv[0] << " -help' or '" << argv[0] << " -usage' for more information" << endl;
+        return 1;
+    }
+    
+//DEBUG
+all = 0;   
+print_id = 0, print_df = 0, print_ssa = 0; 
+    
+    if (all)
+        print_ir = print_graph = print_sets = print_serialize = print_rd = print_lv = print_io = print_dce = print_dc = print_nl = print_tex = print_json = 1;
+    if (edits && (print_rd || print_lv)) {
+        *diag << "Error: -RD and -LV show the sweeps of a full solve and cannot be used with -edit" << endl;
+        return 1;
+    }
+
+    //start workers for -j N
+    unique_ptr<thread_pool> workers;
+    if (num_threads > 1) {
+        workers.reset(new thread_pool(num_threads));
+        pool = workers.get();
+    }
+
+    //map the input, redirect output, a request brings its input and takes its output
+    if (input)
+        ir_text.open(input);
+    else if (!request)
+        ir_text.open_stdin();
+    output_buffer buffer;
+    if (request)
+        ;
+    else if (!output)
+        buffer.open_stdout();
+    else if (!buffer.open(output)) {
+        *diag << "Error: cannot open output file '" << output << "'" << endl;
+        return 1;
+    }
+    ostream out(request ? request : &buffer);
+
+    //add entry and exit bbs
+    ENTRY_ID = bb_names.size();
+    bb_names.push_back("entry");
+    EXIT_ID = bb_names.size();
+    bb_names.push_back("exit");
+    bbs.resize(2);
+    bbs[0].name_id = ENTRY_ID;
+    bbs[1].name_id = EXIT_ID;
+
+    //label id -> ins id, labels that are never placed jump to ins 0
+    vector<int> labels_to_ins_id;
+
+    //entry of the input in the -cache directory: on a hit the cached passes load
+    //their results from it, on a miss they all run and the entry is written.
+    //A damaged section is computed again and the entry rewritten
+    cache_reader cache;
+    string cache_path;
+    uint64_t input_size = ir_text.end() - ir_text.begin(), input_hash = 0;
+    uint32_t cache_options = use_dfst;
+    bool hit = false, damaged = false, stored = false;
+    if (cache_dir) {
+        mkdir(cache_dir, 0777);
+        input_hash = hash_bytes(ir_text.begin(), input_size);
+        cache_path = cache_entry_path(cache_dir, input_hash, cache_options);
+        hit = cache.open(cache_path, input_size, input_hash, cache_options);
+    }
+
+    //analyses, each one runs when an output first needs it
+    pass_manager passes;
+    bool parsed = false;
+    auto cached = [&](cache_section s){
+        if (!hit)
+            return false;
+        if (cache.section(s))
+            return true;
+        damaged = true;
+        return false;
+    };
+    auto need_store = [&]{ return cache_dir && (!hit || damaged); };
+    int parse_pass = passes.add("parse", {}, [&]{
+        if (cached(CACHE_PARSE)) {
+            load_parse(cache, labels_to_ins_id);
+            parsed = true;
+        } else
+            parsed = parse_input(labels_to_ins_id);
+    });
+    int cfg_pass = passes.add("cfg", {parse_pass}, [&]{
+        if (cached(CACHE_CFG))
+            load_cfg(cache);
+        else
+            build_cfg(labels_to_ins_id);
+    });
+    int defs_pass = passes.add("defs", {cfg_pass}, [&]{
+        number_definitions();
+        dataflow = make_dataflow();
+    });
+    int gen_kill_pass = passes.add("gen/kill", {defs_pass}, [&]{
+        if (cached(CACHE_GEN_KILL))
+            dataflow->load(CACHE_GEN_KILL, cache);
+        else
+            dataflow->gen_kill();
+    });
+    int use_def_pass = passes.add("use/def", {defs_pass}, [&]{
+        if (cached(CACHE_USE_DEF))
+            dataflow->load(CACHE_USE_DEF, cache);
+        else
+            dataflow->use_def();
+    });
+    //the -RD and -LV traces show every sweep, so they always solve
+    int rd_pass = passes.add("rd", {gen_kill_pass}, [&]{
+        if (!print_rd && cached(CACHE_RD))
+            dataflow->load(CACHE_RD, cache);
+        else
+            dataflow->reaching_definitions(print_rd ? &out : NULL);
+    });
+    int lv_pass = passes.add("lv", {use_def_pass}, [&]{
+        if (!print_lv && cached(CACHE_LV))
+            dataflow->load(CACHE_LV, cache);
+        else
+            dataflow->live_variables(print_lv ? &out : NULL);
+    });
+    int dom_pass = passes.add("dom", {cfg_pass}, [&]{
+        if (cached(CACHE_DOM))
+            load_dom(cache);
+        else
+            calc_dominators();
+    });
+    //renaming changes the instructions and names, so the entry is written before it
+    //or at the end, every cached pass that has not run yet runs for it
+    int store_pass = passes.add("store", {}, [&]{
+        if (!need_store())
+            return;
+        for (auto p : {cfg_pass, gen_kill_pass, use_def_pass, rd_pass, lv_pass, dom_pass})
+            passes.require(p);
+        cache_writer w;
+        save_parse(w, labels_to_ins_id);
+        save_cfg(w);
+        dataflow->save(CACHE_GEN_KILL, w);
+        dataflow->save(CACHE_USE_DEF, w);
+        dataflow->save(CACHE_RD, w);
+        dataflow->save(CACHE_LV, w);
+        save_dom(w);
+        stored = w.write(cache_path, input_size, input_hash, cache_options);
+        if (!stored)
+            *diag << "Warning: cannot write cache entry '" << cache_path << "'" << endl;
+    });
+    //-edit: the edits go into the analyzed program and RD and LV are updated from
+    //their fixpoint, the CFG, dominators and loops stay as they are.
+    //The cache entry is of the input, so it is written first
+    input_buffer edit_text;
+    vector<int> edited_blocks;
+    bool edited = false;
+    vector<int> edit_deps = {rd_pass, lv_pass};
+    if (cache_dir)
+        edit_deps.push_back(store_pass);
+    int edit_pass = passes.add("edit", edit_deps, [&]{
+        edit_text.open(edits);
+        edited = apply_edits(edit_text, edited_blocks);
+        if (edited)
+            dataflow->update(edited_blocks);
+    });
+    int loops_pass = passes.add("loops", {dom_pass}, []{ loop_tree.build(flow_graph, dom_tree); });
+    vector<int> phi_deps = {dom_pass};
+    if (use_pruned)
+        phi_deps.push_back(lv_pass);
+    if (edits)
+        phi_deps.push_back(edit_pass);
+    int phi_pass = passes.add("phi", phi_deps, place_phi);
+    vector<int> ssa_deps = {phi_pass, lv_pass};
+    if (cache_dir)
+        ssa_deps.push_back(store_pass);
+    int ssa_pass = passes.add("ssa", ssa_deps, construct_ssa);
+
+    //ins input
+    passes.require(parse_pass);
+    if (!parsed)
+        return 1;
+    if (ins_list.size() == 0) {
+        *diag << "Error: empty intermediate representation" << endl;
+        return 1;
+    }
+    passes.require(cfg_pass);
+    if (edits) {
+        passes.require(edit_pass);
+        if (!edited)
+            return 1;
+    }
+
+    //outputs in the order they are written, each one runs the passes it prints first
+    vector<unique_ptr<emitter> > outputs;
+    auto add = [&](emitter *e){ outputs.push_back(unique_ptr<emitter>(e)); };
+    if (print_ir)
+        add(new text_emitter(IR_TEXT, {}));
+    if (print_graph)
+        add(new dot_emitter({}));
+    if (print_sets)
+        add(new text_emitter(SETS_TEXT, {gen_kill_pass, use_def_pass}));
+    if (print_serialize)
+        add(new serialize_emitter({use_def_pass}));
+    if (print_rd)
+        add(new text_emitter(RD_TEXT, {rd_pass}));
+    if (print_lv)
+        add(new text_emitter(LV_TEXT, {lv_pass}));
+    if (print_io)
+        add(new text_emitter(IO_TEXT, {rd_pass, lv_pass}));
+    if (print_dce)
+        add(new text_emitter(DCE_TEXT, {lv_pass}));
+    if (print_dc)
+        add(new text_emitter(DC_TEXT, {}));
+    if (print_nl)
+        add(new text_emitter(NL_TEXT, {loops_pass}));
+    if (print_id)
+        add(new text_emitter(ID_TEXT, {dom_pass}));
+    if (print_df)
+        add(new text_emitter(DF_TEXT, {dom_pass}));
+    if (print_ssa)
+        add(new text_emitter(SSA_TEXT, {ssa_pass}));
+    if (print_tex)
+        add(new tex_emitter({ssa_pass}));
+    if (print_json)
+        add(new json_emitter({lv_pass, dom_pass}));
+    for (auto &e : outputs) {
+        for (auto p : e->needs())
+            passes.require(p);
+        e->emit(out);
+    }
+    if (!buffer.close()) {
+        *diag << "Error: cannot write output" << endl;
+        return 1;
+    }
+    if (cache_dir) {
+        passes.require(store_pass);
+        //damage found after renaming, the next run writes the entry again
+        if (need_store() && !stored)
+            unlink(cache_path.c_str());
+    }
+
+    if (print_time_passes)
+        passes.report(*diag);
     return 0;
 }
+
+int main(int argc, char* argv[])
+{
+    return run(argc, argv, NULL);
+}
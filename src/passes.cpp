@@ -0,0 +1,42 @@
+#include <chrono>
+#include <iomanip>
+#include "passes.h"
+
+int pass_manager::add(const string& name, const vector<int>& deps, function<void()> run)
+{
+	passes.push_back({name, deps, run, false, 0});
+	return passes.size() - 1;
+}
+
+void pass_manager::require(int id)
+{
+	if (passes[id].done)
+		return;
+	for (auto d : passes[id].deps)
+		require(d);
+	//passes required while this one runs are timed on their own
+	double outer = nested;
+	nested = 0;
+	auto start = chrono::steady_clock::now();
+	passes[id].run();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	passes[id].seconds = seconds - nested;
+	nested = outer + seconds;
+	passes[id].done = true;
+	ran.push_back(id);
+}
+
+void pass_manager::report(ostream& os) const
+{
+	ios::fmtflags flags = os.flags();
+	streamsize precision = os.precision();
+	double total = 0;
+	os << "Pass execution times:" << endl;
+	for (auto i : ran) {
+		os << "  " << left << setw(12) << passes[i].name << right << fixed << setprecision(3) << setw(10) << passes[i].seconds * 1000 << " ms" << endl;
+		total += passes[i].seconds;
+	}
+	os << "  " << left << setw(12) << "total" << right << fixed << setprecision(3) << setw(10) << total * 1000 << " ms" << endl;
+	os.flags(flags);
+	os.precision(precision);
+}
@@ -0,0 +1,47 @@
+#ifndef PASSES_H
+#define PASSES_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+//analyses computed on demand: a pass runs the first time it is required, after
+//the passes it depends on, and its result is kept for every later request.
+//A pass may also require others while it runs
+class pass_manager
+{
+
+private:
+    struct pass
+    {
+        string name;
+        vector<int> deps;
+        function<void()> run;
+        bool done;
+        double seconds; //without the passes it depends on
+    };
+
+    vector<pass> passes;
+    //passes in the order they ran
+    vector<int> ran;
+    //time of the passes that ran inside the one running now
+    double nested;
+
+public:
+    pass_manager() : nested(0) {}
+
+    //id of the new pass, deps are ids of passes added before
+    int add(const string& name, const vector<int>& deps, function<void()> run);
+
+    void require(int id);
+
+    bool done(int id) const { return passes[id].done; }
+
+    //time of every pass that ran, in the order they ran
+    void report(ostream& os) const;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "reader.h"
+
+void input_buffer::open(const char *path)
+{
+	close();
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return;
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			madvise(p, st.st_size, MADV_SEQUENTIAL);
+			map_ = p;
+			data_ = (const char *)p;
+			size_ = st.st_size;
+			::close(fd);
+			return;
+		}
+	}
+	read_fd(fd);
+	::close(fd);
+}
+
+void input_buffer::open_stdin()
+{
+	close();
+	read_fd(0);
+}
+
+void input_buffer::read_fd(int fd)
+{
+	const size_t block = 1 << 20;
+	size_t n = 0;
+	for (;;) {
+		copy_.resize(n + block);
+		ssize_t r = read(fd, &copy_[n], block);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0)
+			break;
+		n += r;
+	}
+	copy_.resize(n);
+	data_ = copy_.empty() ? "" : &copy_[0];
+	size_ = n;
+}
+
+void input_buffer::adopt(vector<char>& data)
+{
+	close();
+	copy_.swap(data);
+	data_ = copy_.empty() ? "" : &copy_[0];
+	size_ = copy_.size();
+}
+
+void input_buffer::close()
+{
+	if (map_)
+		munmap(map_, size_);
+	map_ = NULL;
+	vector<char>().swap(copy_);
+	data_ = "";
+	size_ = 0;
+}
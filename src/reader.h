@@ -0,0 +1,77 @@
+#ifndef READER_H
+#define READER_H
+
+#include <vector>
+#include "strview.h"
+
+using namespace std;
+
+//the whole input in one buffer: a read only mapping of a regular file,
+//or a copy read in large blocks for stdin, pipes and files that cannot be mapped.
+//Views into the buffer stay valid while it lives
+class input_buffer
+{
+
+private:
+    const char *data_;
+    size_t size_;
+    void *map_;
+    vector<char> copy_;
+
+    void read_fd(int fd);
+
+    input_buffer(const input_buffer&);
+
+    input_buffer& operator=(const input_buffer&);
+
+public:
+    input_buffer() : data_(""), size_(0), map_(NULL) {}
+
+    ~input_buffer() { close(); }
+
+    //a file that cannot be opened reads as empty
+    void open(const char *path);
+
+    void open_stdin();
+
+    //take the characters of data, which is left empty
+    void adopt(vector<char>& data);
+
+    void close();
+
+    const char *begin() const { return data_; }
+
+    const char *end() const { return data_ + size_; }
+};
+
+//next line at p without its '\n', like getline, false at end
+inline bool next_line(const char *&p, const char *end, strview& line)
+{
+    if (p == end)
+        return false;
+    const char *e = (const char *)memchr(p, '\n', end - p);
+    if (!e)
+        e = end;
+    line = strview(p, e - p);
+    p = e == end ? end : e + 1;
+    return true;
+}
+
+//split a line into whitespace separated tokens, as reading it with >> would
+inline void tokenize(strview line, vector<strview>& tokens)
+{
+    tokens.clear();
+    const char *p = line.s, *end = line.s + line.n;
+    for (;;) {
+        while (p != end && (*p == ' ' || (*p >= '\t' && *p <= '\r')))
+            ++p;
+        if (p == end)
+            return;
+        const char *b = p;
+        while (p != end && !(*p == ' ' || (*p >= '\t' && *p <= '\r')))
+            ++p;
+        tokens.push_back(strview(b, p - b));
+    }
+}
+
+#endif
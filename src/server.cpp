@@ -0,0 +1,180 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sstream>
+#include <exception>
+#include "reader.h"
+#include "threadpool.h"
+#include "server.h"
+
+namespace {
+
+//longest request header
+const size_t header_max = 1 << 16;
+
+//one client connection, reads are buffered
+class connection
+{
+
+private:
+	int fd_;
+	vector<char> buf_;
+	size_t pos_, end_;
+
+	//more bytes at the end of the buffer, false at the end of the input or on errors
+	bool fill()
+	{
+		if (pos_ > 0) {
+			copy(buf_.begin() + pos_, buf_.begin() + end_, buf_.begin());
+			end_ -= pos_;
+			pos_ = 0;
+		}
+		for (;;) {
+			ssize_t r = recv(fd_, &buf_[end_], buf_.size() - end_, 0);
+			if (r < 0 && errno == EINTR)
+				continue;
+			if (r <= 0)
+				return false;
+			end_ += r;
+			return true;
+		}
+	}
+
+	connection(const connection&);
+
+	connection& operator=(const connection&);
+
+public:
+	explicit connection(int fd) : fd_(fd), buf_(header_max), pos_(0), end_(0) {}
+
+	~connection() { ::close(fd_); }
+
+	//next line without its '\n', false at the end of the input or for a line over header_max
+	bool read_line(string& line)
+	{
+		for (;;) {
+			const char *b = buf_.data() + pos_;
+			const char *e = (const char *)memchr(b, '\n', end_ - pos_);
+			if (e) {
+				line.assign(b, e - b);
+				pos_ += e - b + 1;
+				return true;
+			}
+			if (end_ - pos_ == buf_.size() || !fill())
+				return false;
+		}
+	}
+
+	//the next n bytes
+	bool read(vector<char>& out, size_t n)
+	{
+		out.resize(n);
+		size_t k = min(n, end_ - pos_);
+		copy(buf_.begin() + pos_, buf_.begin() + pos_ + k, out.begin());
+		pos_ += k;
+		while (k < n) {
+			ssize_t r = recv(fd_, &out[k], n - k, 0);
+			if (r < 0 && errno == EINTR)
+				continue;
+			if (r <= 0)
+				return false;
+			k += r;
+		}
+		return true;
+	}
+
+	bool write(const string& s)
+	{
+		const char *p = s.data();
+		size_t n = s.size();
+		while (n > 0) {
+			ssize_t r = send(fd_, p, n, MSG_NOSIGNAL);
+			if (r < 0 && errno == EINTR)
+				continue;
+			if (r <= 0)
+				return false;
+			p += r;
+			n -= r;
+		}
+		return true;
+	}
+};
+
+//requests of one connection until the client closes it or breaks the framing
+void serve_connection(int fd, request_handler& handle)
+{
+	connection c(fd);
+	string line;
+	vector<strview> tokens;
+	while (c.read_line(line)) {
+		tokenize(line, tokens);
+		if (tokens.empty() || tokens[0].n > 18 || strspn(tokens[0].s, "0123456789") < tokens[0].n)
+			return;
+		server_request r;
+		for (size_t k = 1; k < tokens.size(); ++k)
+			r.args.push_back(tokens[k]);
+		if (!c.read(r.text, strtoull(string(tokens[0]).c_str(), NULL, 10)))
+			return;
+		ostringstream out, err;
+		int status;
+		try {
+			status = handle(r, out, err);
+		} catch (exception& e) {
+			err << "Error: " << e.what() << endl;
+			status = 1;
+		}
+		string o = out.str(), e = err.str();
+		if (!c.write(to_string(status) + " " + to_string(o.size()) + " " + to_string(e.size()) + "\n") ||
+				!c.write(o) || !c.write(e))
+			return;
+	}
+}
+
+}
+
+bool serve(const char *path, unsigned workers, request_handler handle)
+{
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return false;
+	}
+	strcpy(addr.sun_path, path);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(path);
+	if (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+		int e = errno;
+		::close(fd);
+		errno = e;
+		return false;
+	}
+	thread_pool pool(workers);
+	for (;;) {
+		int c = accept(fd, NULL, NULL);
+		if (c >= 0) {
+			pool.submit([c, &handle]{ serve_connection(c, handle); });
+			continue;
+		}
+		if (errno == EINTR || errno == ECONNABORTED)
+			continue;
+		//out of descriptors, wait for connections to end
+		if (errno == EMFILE || errno == ENFILE) {
+			usleep(10000);
+			continue;
+		}
+		int e = errno;
+		::close(fd);
+		errno = e;
+		return false;
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+//one request of a -server client: the options as on the command line and the IR text
+struct server_request
+{
+    vector<string> args;
+    vector<char> text;
+};
+
+//runs a request, writes its output to out and its diagnostics to err,
+//returns the exit status the command line would give
+typedef function<int(server_request& r, ostream& out, ostream& err)> request_handler;
+
+//framed requests over a Unix stream socket, a connection carries any number of
+//them one after another:
+//  request   "<text size> <options>\n" followed by the IR text
+//  response  "<exit status> <output size> <diagnostics size>\n" followed by the
+//            output and the diagnostics
+//A socket file left at path is replaced. Every connection is served by one of
+//workers threads, returns false with errno set when the socket cannot be set up
+bool serve(const char *path, unsigned workers, request_handler handle);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef STRVIEW_H
+#define STRVIEW_H
+
+#include <iostream>
+#include <string>
+#include <string.h>
+
+using namespace std;
+
+//characters owned by someone else, the owner must outlive the view
+struct strview
+{
+    static const size_t npos = string::npos;
+
+    const char *s;
+    size_t n;
+
+    strview() : s(""), n(0) {}
+
+    strview(const char *a, size_t b) : s(a), n(b) {}
+
+    strview(const char *a) : s(a), n(strlen(a)) {}
+
+    strview(const string& a) : s(a.data()), n(a.size()) {}
+
+    size_t size() const { return n; }
+
+    bool empty() const { return n == 0; }
+
+    char operator[](size_t i) const { return s[i]; }
+
+    strview substr(size_t pos, size_t len = npos) const { return strview(s + pos, len < n - pos ? len : n - pos); }
+
+    size_t find_first_of(char c) const
+    {
+        const void *p = memchr(s, c, n);
+        return p ? (const char *)p - s : npos;
+    }
+
+    size_t find_last_of(char c) const
+    {
+        for (size_t i = n; i-- > 0;)
+            if (s[i] == c)
+                return i;
+        return npos;
+    }
+
+    operator string() const { return string(s, n); }
+
+    friend bool operator==(const strview& a, const strview& b) { return a.n == b.n && memcmp(a.s, b.s, a.n) == 0; }
+
+    friend bool operator!=(const strview& a, const strview& b) { return !(a == b); }
+
+    friend ostream& operator<<(ostream& os, const strview& v) { return os.write(v.s, v.n); }
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "threadpool.h"
+
+namespace {
+
+//index of the worker running on this thread, -1 outside the pool
+thread_local int current_worker = -1;
+
+}
+
+thread_pool::thread_pool(unsigned n) : queued(0), pending(0), next_queue(0), stop(false)
+{
+	if (n == 0)
+		n = 1;
+	for (unsigned i = 0; i < n; ++i)
+		queues.push_back(unique_ptr<worker_queue>(new worker_queue));
+	for (unsigned i = 0; i < n; ++i)
+		workers.push_back(thread(&thread_pool::run, this, i));
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		lock_guard<mutex> lock(m);
+		stop = true;
+	}
+	wake.notify_all();
+	for (auto &i : workers)
+		i.join();
+}
+
+void thread_pool::submit(function<void()> task)
+{
+	unsigned q = current_worker >= 0 ? current_worker : next_queue++ % queues.size();
+	++pending;
+	{
+		lock_guard<mutex> lock(queues[q]->m);
+		queues[q]->tasks.push_back(move(task));
+	}
+	{
+		lock_guard<mutex> lock(m);
+		++queued;
+	}
+	wake.notify_one();
+}
+
+bool thread_pool::take(unsigned self, function<void()>& task)
+{
+	{
+		lock_guard<mutex> lock(queues[self]->m);
+		if (!queues[self]->tasks.empty()) {
+			task = move(queues[self]->tasks.back());
+			queues[self]->tasks.pop_back();
+			return true;
+		}
+	}
+	for (unsigned k = 1; k < queues.size(); ++k) {
+		worker_queue &q = *queues[(self + k) % queues.size()];
+		lock_guard<mutex> lock(q.m);
+		if (!q.tasks.empty()) {
+			task = move(q.tasks.front());
+			q.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void thread_pool::run(unsigned self)
+{
+	current_worker = self;
+	for (;;) {
+		{
+			unique_lock<mutex> lock(m);
+			wake.wait(lock, [this]{return stop || queued > 0;});
+			if (queued == 0)
+				return;
+			--queued;
+		}
+		//a task is reserved for us, it may sit in any deque
+		function<void()> task;
+		while (!take(self, task))
+			this_thread::yield();
+		task();
+		if (--pending == 0) {
+			lock_guard<mutex> lock(m);
+			idle.notify_all();
+		}
+	}
+}
+
+void thread_pool::wait()
+{
+	unique_lock<mutex> lock(m);
+	idle.wait(lock, [this]{return pending == 0;});
+}
+
+void thread_pool::parallel_for(int n, function<void(int)> body)
+{
+	shared_ptr<atomic<int> > next(new atomic<int>(0)), done(new atomic<int>(0));
+	auto work = [=]() {
+		int i;
+		while ((i = (*next)++) < n) {
+			body(i);
+			++*done;
+		}
+	};
+	for (unsigned i = 1; i < workers.size() && i < (unsigned)n; ++i)
+		submit(work);
+	work();
+	//remaining items are being run by other threads
+	while (*done < n)
+		this_thread::yield();
+}
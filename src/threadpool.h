@@ -0,0 +1,61 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+//fixed set of worker threads with one task deque per worker:
+//a worker pops its own newest task and steals the oldest task of another
+//worker when its deque is empty. Tasks may submit more tasks.
+class thread_pool
+{
+
+private:
+    struct worker_queue
+    {
+        mutex m;
+        deque<function<void()> > tasks;
+    };
+
+    vector<unique_ptr<worker_queue> > queues;
+    vector<thread> workers;
+    mutex m;
+    condition_variable wake, idle;
+    atomic<long> queued, pending;
+    atomic<unsigned> next_queue;
+    bool stop;
+
+    bool take(unsigned self, function<void()>& task);
+
+    void run(unsigned self);
+
+    thread_pool(const thread_pool&);
+
+    thread_pool& operator=(const thread_pool&);
+
+public:
+    explicit thread_pool(unsigned n);
+
+    ~thread_pool();
+
+    unsigned size() const { return workers.size(); }
+
+    void submit(function<void()> task);
+
+    //block until every submitted task has finished
+    void wait();
+
+    //run body(i) for i in [0, n), the calling thread takes part,
+    //so it may be used from inside a task
+    void parallel_for(int n, function<void(int)> body);
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef TRAVERSE_H
+#define TRAVERSE_H
+
+#include <vector>
+
+using namespace std;
+
+//blocks [b, e) of an array that outlives the walk, e.g. children in a dominator tree
+struct block_range
+{
+    const int *b, *e;
+
+    block_range(const int *x, const int *y) : b(x), e(y) {}
+
+    const int *begin() const { return b; }
+
+    const int *end() const { return e; }
+
+    size_t size() const { return e - b; }
+
+    bool empty() const { return b == e; }
+
+    int operator[](size_t i) const { return b[i]; }
+};
+
+//depth first walk from root on an explicit stack, so chains of any length are safe.
+//edges(b) gives the blocks next to b as a range that outlives the walk
+//(succ or pred of a block, children in a tree), they are taken in range order.
+//enter(b) is called in preorder and leave(b) in postorder, exactly when a
+//recursive walk would. Blocks with seen[b] set are skipped, the walk sets it on
+//every block it enters, root included
+template<typename Seen, typename Edges, typename Enter, typename Leave>
+void depth_first(int root, Seen& seen, Edges edges, Enter enter, Leave leave)
+{
+    typedef decltype(edges(root).begin()) iterator;
+    struct frame
+    {
+        int b;
+        iterator next, end;
+    };
+    vector<frame> stack;
+    seen[root] = true;
+    enter(root);
+    stack.push_back({root, edges(root).begin(), edges(root).end()});
+    while (!stack.empty()) {
+        frame &f = stack.back();
+        if (f.next == f.end) {
+            int b = f.b;
+            stack.pop_back();
+            leave(b);
+            continue;
+        }
+        int s = *f.next++;
+        if (seen[s])
+            continue;
+        seen[s] = true;
+        enter(s);
+        stack.push_back({s, edges(s).begin(), edges(s).end()});
+    }
+}
+
+//depth first walk of a tree, every block is reached once so nothing is marked
+template<typename Children, typename Enter, typename Leave>
+void tree_walk(int root, Children children, Enter enter, Leave leave)
+{
+    typedef decltype(children(root).begin()) iterator;
+    struct frame
+    {
+        int b;
+        iterator next, end;
+    };
+    vector<frame> stack;
+    enter(root);
+    stack.push_back({root, children(root).begin(), children(root).end()});
+    while (!stack.empty()) {
+        frame &f = stack.back();
+        if (f.next == f.end) {
+            int b = f.b;
+            stack.pop_back();
+            leave(b);
+            continue;
+        }
+        int s = *f.next++;
+        enter(s);
+        stack.push_back({s, children(s).begin(), children(s).end()});
+    }
+}
+
+//for walks that need only one of the hooks
+struct no_visit
+{
+    void operator()(int) const {}
+};
+
+#endif
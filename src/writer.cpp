@@ -0,0 +1,100 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include "writer.h"
+
+bool output_buffer::open(const char *path)
+{
+	close();
+	int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0)
+		return false;
+	fd_ = fd;
+	own_ = true;
+	failed_ = false;
+	setp(&buf_[0], &buf_[0] + buf_.size());
+	return true;
+}
+
+void output_buffer::open_stdout()
+{
+	close();
+	fd_ = 1;
+	own_ = false;
+	failed_ = false;
+	setp(&buf_[0], &buf_[0] + buf_.size());
+}
+
+bool output_buffer::close()
+{
+	if (fd_ < 0)
+		return !failed_;
+	drain();
+	if (own_ && ::close(fd_) != 0)
+		failed_ = true;
+	fd_ = -1;
+	setp(NULL, NULL);
+	return !failed_;
+}
+
+bool output_buffer::write_fd(const char *p, size_t n)
+{
+	//after a failed write the rest of the output is dropped
+	while (n > 0 && !failed_) {
+		ssize_t r = write(fd_, p, n);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0) {
+			failed_ = true;
+			break;
+		}
+		p += r;
+		n -= r;
+	}
+	return !failed_;
+}
+
+bool output_buffer::drain()
+{
+	bool ok = write_fd(pbase(), pptr() - pbase());
+	setp(&buf_[0], &buf_[0] + buf_.size());
+	return ok;
+}
+
+output_buffer::int_type output_buffer::overflow(int_type c)
+{
+	if (fd_ < 0 || !drain())
+		return traits_type::eof();
+	if (!traits_type::eq_int_type(c, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+streamsize output_buffer::xsputn(const char *s, streamsize n)
+{
+	if (fd_ < 0)
+		return 0;
+	if (n <= epptr() - pptr()) {
+		memcpy(pptr(), s, n);
+		pbump(n);
+		return n;
+	}
+	if (!drain())
+		return 0;
+	//a piece longer than the buffer goes out as it is
+	if ((size_t)n >= buf_.size())
+		return write_fd(s, n) ? n : 0;
+	memcpy(pptr(), s, n);
+	pbump(n);
+	return n;
+}
+
+int output_buffer::sync()
+{
+	if (fd_ < 0)
+		return 0;
+	return drain() ? 0 : -1;
+}
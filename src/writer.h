@@ -0,0 +1,52 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+//stream buffer over a file descriptor: output collects in one large buffer that
+//is reused and written out with write(2) when it fills up and on close, so a
+//stream over it never makes small writes. Endl still flushes, use '\n'
+class output_buffer : public streambuf
+{
+
+private:
+    vector<char> buf_;
+    int fd_;
+    bool own_, failed_;
+
+    //the buffered output, the buffer is empty after it
+    bool drain();
+
+    bool write_fd(const char *p, size_t n);
+
+    output_buffer(const output_buffer&);
+
+    output_buffer& operator=(const output_buffer&);
+
+protected:
+    int_type overflow(int_type c);
+
+    streamsize xsputn(const char *s, streamsize n);
+
+    int sync();
+
+public:
+    static const size_t block = 1 << 20;
+
+    output_buffer() : buf_(block), fd_(-1), own_(false), failed_(false) {}
+
+    ~output_buffer() { close(); }
+
+    //false if the file cannot be created
+    bool open(const char *path);
+
+    void open_stdout();
+
+    //writes out what is left, false if any output was lost
+    bool close();
+};
+
+#endif